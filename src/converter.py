@@ -6,7 +6,7 @@ import librosa
 import numpy as np
 
 
-def convert_m4a_to_txt(input_path: Path, output_path: Path, seconds: Optional[float] = None) -> None:
+def convert_m4a_to_txt(input_path: Path, output_path: Path, seconds: Optional[float] = None, binary: bool = False) -> None:
 	if not input_path.is_file():
 		raise FileNotFoundError(f"File di input non trovato: {input_path}")
 
@@ -16,7 +16,11 @@ def convert_m4a_to_txt(input_path: Path, output_path: Path, seconds: Optional[fl
 		n_samples = int(sr * seconds)
 		y = y[:n_samples]
 
-	np.savetxt(output_path, y, fmt="%.6f")
+	if binary:
+		# Raw interleaved complex<double> samples, as read by the Batch engine
+		y.astype(np.complex128).tofile(output_path)
+	else:
+		np.savetxt(output_path, y, fmt="%.6f")
 
 	print(f"Done! Saved {len(y)} samples to '{output_path}'.")
 
@@ -37,6 +41,12 @@ def main() -> None:
 		default=None,
 		help="Number of seconds to convert (default: entire file)",
 	)
+	parser.add_argument(
+		"-b",
+		"--binary",
+		action="store_true",
+		help="Write raw complex<double> samples instead of text (input of the Batch method)",
+	)
 
 	args = parser.parse_args()
 
@@ -46,7 +56,7 @@ def main() -> None:
 	else:
 		output_path = input_path.with_suffix(".txt")
 
-	convert_m4a_to_txt(input_path, output_path, args.seconds)
+	convert_m4a_to_txt(input_path, output_path, args.seconds, args.binary)
 
 
 if __name__ == "__main__":
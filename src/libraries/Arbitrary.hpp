@@ -0,0 +1,339 @@
+/**
+ * @file Arbitrary.hpp
+ * @brief Header file for the distributed FFT of arbitrary length.
+ */
+#ifndef ARBITRARY_HPP
+#define ARBITRARY_HPP
+
+#include "Fourier.hpp"
+#include "Kernels.hpp"
+#include "../utilities/Timer.hpp"
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class Arbitrary
+ * @brief Distributed FFT of any length N, using MPI and OpenMP.
+ *
+ * N is split as N1 * N2 (N1 the largest divisor not above sqrt(N)) and computed with
+ * the four-step (transpose) algorithm:
+ *   1. rank 0 scatters the N1 rows x[r + N1*j] (j = 0 .. N2-1), unevenly when N1 is
+ *      not a multiple of the number of ranks;
+ *   2. every rank computes the N2-point DFT of its rows and multiplies them by the
+ *      twiddles exp(-2*pi*i*r*k2/N);
+ *   3. an all-to-all exchange redistributes the matrix by columns (again unevenly);
+ *   4. every rank computes the N1-point DFT of its columns and rank 0 gathers them.
+ * Row and column lengths that are not powers of 2 use the local mixed-radix kernel
+ * (DftKernel, with Rader's algorithm for large prime factors). When N has no divisor
+ * large enough to give every rank a row (e.g. N prime), the whole transform is
+ * computed with Bluestein's algorithm instead, whose two power-of-2 convolution FFTs
+ * are distributed with the four-step algorithm.
+ *
+ * The input must not be padded: read it with read(filename, false).
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class Arbitrary : public Fourier<T> {
+    private:
+        // MPI variables
+        int rank;
+        int size;
+        MPI_Comm comm;
+
+        /**
+         * @brief Length whose global Bluestein tables are cached (0 = none).
+         */
+        size_t bluestein_n = 0;
+
+        /**
+         * @brief Chirp and transformed filter of the global Bluestein algorithm (rank 0 only).
+         */
+        std::vector<T> bluestein_chirp, bluestein_filter;
+
+        /**
+        * @brief Returns the largest divisor of n that is not above sqrt(n).
+        */
+        static size_t row_factor(size_t n) {
+            size_t best = 1;
+            for (size_t d = 2; d * d <= n; ++d) {
+                if (n % d == 0) best = d;
+            }
+            return best;
+        }
+
+        /**
+        * @brief Splits items as evenly as possible over the ranks (the first ones get one more).
+        * @param items The number of items (rows or columns).
+        * @param first Receives the first item of every rank.
+        * @param count Receives the number of items of every rank.
+        */
+        void split(size_t items, std::vector<int>& first, std::vector<int>& count) const {
+            first.resize(size);
+            count.resize(size);
+            size_t begin = 0;
+            for (int p = 0; p < size; ++p) {
+                size_t share = items / size + (static_cast<size_t>(p) < items % size ? 1 : 0);
+                first[p] = static_cast<int>(begin);
+                count[p] = static_cast<int>(share);
+                begin += share;
+            }
+        }
+
+        /**
+        * @brief Computes the forward DFT of count contiguous rows of the given length, one row per thread.
+        */
+        static void transform_rows(T* rows, size_t count, size_t length) {
+            if (count == 0) return;
+            const DftKernel<T> kernel(length);
+
+            #pragma omp parallel
+            {
+                std::vector<T> scratch(kernel.scratch_size());
+                #pragma omp for schedule(static)
+                for (size_t r = 0; r < count; ++r) {
+                    kernel(rows + r * length, scratch.data());
+                }
+            }
+        }
+
+        /**
+        * @brief Distributed forward DFT with the four-step algorithm (collective).
+        * @param data The n input values on rank 0, overwritten with the result (ignored elsewhere).
+        * @param n The transform length.
+        * @throws std::runtime_error On every rank if n exceeds the int counts of MPI.
+        */
+        void four_step(std::vector<T>& data, size_t n) {
+            // Every count and displacement below is at most n values
+            if (n > static_cast<size_t>(INT_MAX)) {
+                throw std::runtime_error("Arbitrary: length " + std::to_string(n) + " exceeds the MPI count limit");
+            }
+            const size_t n1 = row_factor(n);
+            const size_t n2 = n / n1;
+
+            std::vector<int> row_first, row_count, col_first, col_count;
+            split(n1, row_first, row_count);
+            split(n2, col_first, col_count);
+            const size_t my_rows = row_count[rank];
+            const size_t my_cols = col_count[rank];
+
+            // Rank 0 lays out the rows contiguously: matrix[r][j] = x[r + n1*j]
+            std::vector<T> matrix;
+            if (rank == 0) {
+                matrix.resize(n);
+                #pragma omp parallel for schedule(static)
+                for (size_t r = 0; r < n1; ++r) {
+                    for (size_t j = 0; j < n2; ++j) {
+                        matrix[r * n2 + j] = data[r + n1 * j];
+                    }
+                }
+            }
+
+            std::vector<int> counts(size), displs(size);
+            for (int p = 0; p < size; ++p) {
+                counts[p] = static_cast<int>(static_cast<size_t>(row_count[p]) * n2);
+                displs[p] = static_cast<int>(static_cast<size_t>(row_first[p]) * n2);
+            }
+            std::vector<T> rows(my_rows * n2);
+            MPI_Scatterv(matrix.data(), counts.data(), displs.data(), MPI_C_DOUBLE_COMPLEX,
+                         rows.data(), counts[rank], MPI_C_DOUBLE_COMPLEX, 0, comm);
+
+            // Row DFTs, then the twiddles exp(-2*pi*i*r*k2/n) (r*k2 < n, no reduction needed)
+            transform_rows(rows.data(), my_rows, n2);
+            const double angle = -2.0 * std::acos(-1.0) / static_cast<double>(n);
+            #pragma omp parallel for collapse(2) schedule(static)
+            for (size_t r = 0; r < my_rows; ++r) {
+                for (size_t k2 = 1; k2 < n2; ++k2) {
+                    size_t global_r = static_cast<size_t>(row_first[rank]) + r;
+                    rows[r * n2 + k2] *= std::polar(1.0, angle * static_cast<double>(global_r * k2));
+                }
+            }
+
+            // Send every rank the part of my rows in its columns
+            std::vector<int> send_counts(size), send_displs(size), recv_counts(size), recv_displs(size);
+            std::vector<T> send(my_rows * n2);
+            size_t offset = 0;
+            for (int q = 0; q < size; ++q) {
+                send_counts[q] = static_cast<int>(my_rows * static_cast<size_t>(col_count[q]));
+                send_displs[q] = static_cast<int>(offset);
+                for (size_t r = 0; r < my_rows; ++r) {
+                    for (int c = 0; c < col_count[q]; ++c) {
+                        send[offset++] = rows[r * n2 + col_first[q] + c];
+                    }
+                }
+                recv_counts[q] = static_cast<int>(static_cast<size_t>(row_count[q]) * my_cols);
+                recv_displs[q] = static_cast<int>(static_cast<size_t>(row_first[q]) * my_cols);
+            }
+
+            // Blocks arrive in row order, so recv is the n1 x my_cols slice of the matrix
+            std::vector<T> recv(n1 * my_cols);
+            MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), MPI_C_DOUBLE_COMPLEX,
+                          recv.data(), recv_counts.data(), recv_displs.data(), MPI_C_DOUBLE_COMPLEX, comm);
+
+            // Column DFTs on contiguous columns
+            std::vector<T> columns(my_cols * n1);
+            #pragma omp parallel for schedule(static)
+            for (size_t c = 0; c < my_cols; ++c) {
+                for (size_t r = 0; r < n1; ++r) {
+                    columns[c * n1 + r] = recv[r * my_cols + c];
+                }
+            }
+            transform_rows(columns.data(), my_cols, n1);
+
+            for (int p = 0; p < size; ++p) {
+                counts[p] = static_cast<int>(static_cast<size_t>(col_count[p]) * n1);
+                displs[p] = static_cast<int>(static_cast<size_t>(col_first[p]) * n1);
+            }
+            MPI_Gatherv(columns.data(), counts[rank], MPI_C_DOUBLE_COMPLEX,
+                        matrix.data(), counts.data(), displs.data(), MPI_C_DOUBLE_COMPLEX, 0, comm);
+
+            // X[k2 + n2*k1] is element k1 of column k2
+            if (rank == 0) {
+                #pragma omp parallel for schedule(static)
+                for (size_t k2 = 0; k2 < n2; ++k2) {
+                    for (size_t k1 = 0; k1 < n1; ++k1) {
+                        data[k2 + n2 * k1] = matrix[k2 * n1 + k1];
+                    }
+                }
+            }
+        }
+
+        /**
+        * @brief Distributed forward DFT with Bluestein's algorithm (collective).
+        *
+        * X[k] = chirp[k] * (a (*) b)[k] with a = x * chirp and b = conj(chirp), where the
+        * circular convolution of power-of-2 length m >= 2n - 1 is computed with two
+        * distributed four-step FFTs (the inverse one as conj(FFT(conj(.))) / m).
+        * The chirp and the FFT of b are cached for repeated transforms of the same length.
+        *
+        * @param data The n input values on rank 0, overwritten with the result (ignored elsewhere).
+        * @param n The transform length.
+        */
+        void bluestein(std::vector<T>& data, size_t n) {
+            size_t m = 1;
+            while (m < 2 * n - 1) m <<= 1;
+
+            if (bluestein_n != n) {
+                bluestein_n = n;
+                if (rank == 0) {
+                    bluestein_chirp = make_chirp<T>(n);
+                    bluestein_filter.assign(m, T(0));
+                    bluestein_filter[0] = std::conj(bluestein_chirp[0]);
+                    for (size_t k = 1; k < n; ++k) {
+                        bluestein_filter[k] = bluestein_filter[m - k] = std::conj(bluestein_chirp[k]);
+                    }
+                }
+                four_step(bluestein_filter, m);
+            }
+
+            std::vector<T> a;
+            if (rank == 0) {
+                a.assign(m, T(0));
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < n; ++k) {
+                    a[k] = data[k] * bluestein_chirp[k];
+                }
+            }
+
+            four_step(a, m);
+            if (rank == 0) {
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < m; ++k) {
+                    a[k] = std::conj(a[k] * bluestein_filter[k]);
+                }
+            }
+            four_step(a, m);
+
+            if (rank == 0) {
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < n; ++k) {
+                    data[k] = std::conj(a[k]) / static_cast<double>(m) * bluestein_chirp[k];
+                }
+            }
+        }
+
+        /**
+        * @brief Runs the forward or inverse transform of rank 0's input (collective).
+        *
+        * The inverse is computed as conj(DFT(conj(X))) / N.
+        *
+        * @param inverse If true, computes the normalized inverse transform.
+        */
+        void execute(bool inverse) {
+            Timer t;
+
+            unsigned long long global_n = rank == 0 ? this->input->size() : 0;
+            MPI_Bcast(&global_n, 1, MPI_UNSIGNED_LONG_LONG, 0, comm);
+            const size_t n = static_cast<size_t>(global_n);
+
+            std::vector<T> data;
+            if (rank == 0) {
+                data = *(this->input);
+                if (inverse) {
+                    for (T& value : data) value = std::conj(value);
+                }
+            }
+
+            if (n > 1) {
+                // Without a divisor that gives every rank a row, the four-step would leave ranks idle
+                if (size > 1 && row_factor(n) < static_cast<size_t>(size)) {
+                    bluestein(data, n);
+                } else {
+                    four_step(data, n);
+                }
+            }
+
+            if (rank == 0) {
+                if (inverse) {
+                    for (T& value : data) value = std::conj(value) / static_cast<double>(n);
+                }
+                std::copy(data.begin(), data.end(), this->prepare_output(n));
+            }
+
+            this->record_duration(t, n, inverse);
+        }
+
+    public:
+        /**
+         * @brief Constructs an Arbitrary FFT object.
+         *
+         * @param communicator The MPI communicator to use (default: MPI_COMM_WORLD).
+         */
+        Arbitrary(MPI_Comm communicator = MPI_COMM_WORLD) : comm(communicator) {
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+        }
+
+        /**
+         * @brief Computes the forward Fourier Transform of any length.
+         */
+        void compute() override {
+            execute(false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the inverse Fourier Transform of any length.
+         */
+        void reverseCompute() override {
+            execute(true); // inverse = true
+        }
+
+        /**
+         * @brief Prints the statistics of the Arbitrary FFT/IFFT execution.
+         * @param label "FFT" or "IFFT"
+         */
+        void printStats(const std::string& label) override {
+            if (rank == 0) {
+                std::cout << "Arbitrary " << label << " Duration: " << this->duration << " ms" << std::endl;
+            }
+        }
+};
+
+#endif // ARBITRARY_HPP
@@ -0,0 +1,194 @@
+/**
+ * @file Batch.hpp
+ * @brief Header file for the distributed batch FFT engine.
+ */
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "Kernels.hpp"
+#include "../utilities/Timer.hpp"
+#include <mpi.h>
+#include <complex>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ * @class Batch
+ * @brief Computes many independent small FFTs stored in one binary file.
+ *
+ * Whole transforms are assigned to ranks (no cross-rank butterflies) and, inside
+ * a rank, to OpenMP threads. Work is distributed dynamically: each rank claims the
+ * next chunk of transforms from a shared counter on rank 0 (MPI one-sided
+ * fetch-and-add), so ranks that finish early take more work. Every rank reads and
+ * writes its chunks directly with MPI-IO.
+ *
+ * The files contain the transforms back to back as raw interleaved
+ * std::complex<double> values (real, imaginary).
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class Batch {
+    private:
+        // MPI variables
+        int rank;
+        int size;
+        MPI_Comm comm;
+
+        /**
+         * @brief Length of every single transform (a power of 2).
+         */
+        size_t transform_n;
+
+        /**
+         * @brief Number of transforms claimed by a rank at a time.
+         */
+        size_t chunk;
+
+        /**
+         * @brief Duration of the last computation in milliseconds.
+         */
+        long long duration;
+
+        /**
+         * @brief Number of transforms computed by this rank in the last run.
+         */
+        long long local_count;
+
+        /**
+         * @brief Transforms every chunk of in_file into out_file.
+         * @param in_file The input file path.
+         * @param out_file The output file path.
+         * @param inverse Whether to compute inverse FFTs.
+         * @throws std::runtime_error If a file cannot be opened or has a wrong size.
+         */
+        void execute(const char* in_file, const char* out_file, bool inverse) {
+            Timer t;
+
+            MPI_File in, out;
+            if (MPI_File_open(comm, in_file, MPI_MODE_RDONLY, MPI_INFO_NULL, &in) != MPI_SUCCESS) {
+                throw std::runtime_error("Could not open file");
+            }
+
+            MPI_Offset bytes = 0;
+            MPI_File_get_size(in, &bytes);
+            const MPI_Offset transform_bytes = static_cast<MPI_Offset>(transform_n * sizeof(T));
+            if (bytes % transform_bytes != 0) {
+                MPI_File_close(&in);
+                throw std::runtime_error("Input size is not a multiple of the transform length");
+            }
+            const long long total = static_cast<long long>(bytes / transform_bytes);
+
+            if (MPI_File_open(comm, out_file, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &out) != MPI_SUCCESS) {
+                MPI_File_close(&in);
+                throw std::runtime_error("Could not open file");
+            }
+            MPI_File_set_size(out, bytes);
+
+            // Shared work counter, exposed by rank 0
+            long long* counter = nullptr;
+            MPI_Win win;
+            MPI_Win_allocate(rank == 0 ? sizeof(long long) : 0, sizeof(long long),
+                             MPI_INFO_NULL, comm, &counter, &win);
+            if (rank == 0) *counter = 0;
+            MPI_Barrier(comm);
+
+            const std::vector<T> twiddles = make_twiddles<T>(transform_n);
+            std::vector<T> data(chunk * transform_n);
+            const long long step = static_cast<long long>(chunk);
+            local_count = 0;
+
+            while (true) {
+                // Claim the next chunk of transforms
+                long long first = 0;
+                MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+                MPI_Fetch_and_op(&step, &first, MPI_LONG_LONG, 0, 0, MPI_SUM, win);
+                MPI_Win_unlock(0, win);
+                if (first >= total) break;
+
+                long long count = std::min(step, total - first);
+                int elements = static_cast<int>(count * transform_n);
+                MPI_Offset offset = static_cast<MPI_Offset>(first) * transform_bytes;
+
+                MPI_Status status;
+                MPI_File_read_at(in, offset, data.data(), elements, MPI_C_DOUBLE_COMPLEX, &status);
+
+                // Whole transforms per thread, no data shared between iterations
+                #pragma omp parallel for schedule(dynamic)
+                for (long long b = 0; b < count; ++b) {
+                    fft_in_place(data.data() + b * transform_n, transform_n, twiddles, inverse);
+                }
+
+                MPI_File_write_at(out, offset, data.data(), elements, MPI_C_DOUBLE_COMPLEX, &status);
+                local_count += count;
+            }
+
+            MPI_Win_free(&win);
+            MPI_File_close(&in);
+            MPI_File_close(&out);
+
+            this->duration = t.stop_and_return();
+        }
+
+    public:
+        /**
+         * @brief Constructs a Batch FFT engine.
+         *
+         * @param n The length of every transform (must be a power of 2).
+         * @param transforms_per_chunk Number of transforms a rank claims at a time.
+         * @param communicator The MPI communicator to use (default: MPI_COMM_WORLD).
+         * @throws std::invalid_argument If n is not a power of 2 or the chunk is empty.
+         */
+        Batch(size_t n, size_t transforms_per_chunk = 64, MPI_Comm communicator = MPI_COMM_WORLD)
+            : comm(communicator), transform_n(n), chunk(transforms_per_chunk), duration(0), local_count(0) {
+            if (n == 0 || (n & (n - 1)) != 0) {
+                throw std::invalid_argument("Transform length must be a power of 2");
+            }
+            if (chunk == 0) {
+                throw std::invalid_argument("Chunk size must be positive");
+            }
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+        }
+
+        /**
+         * @brief Computes the forward FFT of every transform in in_file (collective).
+         * @param in_file The input binary file.
+         * @param out_file The output binary file.
+         */
+        void compute(const char* in_file, const char* out_file) {
+            execute(in_file, out_file, false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the inverse FFT of every transform in in_file (collective).
+         * @param in_file The input binary file.
+         * @param out_file The output binary file.
+         */
+        void reverseCompute(const char* in_file, const char* out_file) {
+            execute(in_file, out_file, true); // inverse = true
+        }
+
+        /**
+         * @brief Prints the statistics of the Batch FFT/IFFT execution (collective).
+         *
+         * Rank 0 prints the duration and how many transforms every rank computed.
+         * @param label "FFT" or "IFFT"
+         */
+        void printStats(const std::string& label) {
+            std::vector<long long> counts(rank == 0 ? size : 0);
+            MPI_Gather(&local_count, 1, MPI_LONG_LONG,
+                       rank == 0 ? counts.data() : nullptr, 1, MPI_LONG_LONG, 0, comm);
+            if (rank == 0) {
+                std::cout << "Batch " << label << " Duration: " << this->duration << " ms" << std::endl;
+                std::cout << "Batch " << label << " transforms per rank:";
+                for (long long c : counts) std::cout << " " << c;
+                std::cout << std::endl;
+            }
+        }
+};
+
+#endif // BATCH_HPP
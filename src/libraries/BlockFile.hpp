@@ -0,0 +1,424 @@
+/**
+ * @file BlockFile.hpp
+ * @brief Block-compressed sample files: byte-shuffled values, LZ4 block codec, block index.
+ */
+
+#ifndef BLOCK_FILE_HPP
+#define BLOCK_FILE_HPP
+
+#include "Compression.hpp"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Default number of samples per block (1 MiB of complex doubles before compression).
+ */
+constexpr size_t BLOCK_FILE_SAMPLES = 65536;
+
+/**
+ * @brief Returns the largest compressed size of n bytes (incompressible input plus token overhead).
+ */
+inline size_t lz_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+/**
+ * @brief Compresses n bytes in the LZ4 block format (greedy matching on a hash of 4-byte sequences).
+ *
+ * Every sequence is a token (literal length, match length - 4), the literals, a
+ * 16-bit little-endian offset and the extra length bytes; the block ends with
+ * literals only. The output can be decoded by any LZ4 block decoder.
+ *
+ * @param src The bytes to compress.
+ * @param n The number of bytes.
+ * @param dst At least lz_bound(n) bytes.
+ * @return size_t The compressed size.
+ */
+inline size_t lz_compress(const uint8_t* src, size_t n, uint8_t* dst) {
+    constexpr size_t MIN_MATCH = 4, LAST_LITERALS = 5, MATCH_LIMIT = 12, MAX_OFFSET = 65535;
+    constexpr unsigned HASH_BITS = 14;
+    uint8_t* op = dst;
+
+    auto read32 = [src](size_t at) {
+        uint32_t value;
+        std::memcpy(&value, src + at, sizeof(value));
+        return value;
+    };
+    auto length = [&op](size_t value) {
+        for (; value >= 255; value -= 255) *op++ = 255;
+        *op++ = static_cast<uint8_t>(value);
+    };
+    auto literals = [&](size_t from, size_t count, unsigned match_code) {
+        *op++ = static_cast<uint8_t>((std::min<size_t>(count, 15) << 4) | match_code);
+        if (count >= 15) length(count - 15);
+        std::memcpy(op, src + from, count);
+        op += count;
+    };
+
+    size_t anchor = 0;
+    if (n > MATCH_LIMIT) {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+        const size_t limit = n - MATCH_LIMIT;
+        size_t ip = 1;
+        while (ip < limit) {
+            const uint32_t sequence = read32(ip);
+            const size_t h = static_cast<uint32_t>(sequence * 2654435761u) >> (32 - HASH_BITS);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+
+            if (ip - candidate > MAX_OFFSET || read32(candidate) != sequence) {
+                ip += 1 + ((ip - anchor) >> 6); // skip faster through incompressible data
+                continue;
+            }
+
+            size_t match = MIN_MATCH;
+            while (ip + match < n - LAST_LITERALS && src[candidate + match] == src[ip + match]) ++match;
+
+            const size_t extra = match - MIN_MATCH;
+            literals(anchor, ip - anchor, static_cast<unsigned>(std::min<size_t>(extra, 15)));
+            const size_t offset = ip - candidate;
+            *op++ = static_cast<uint8_t>(offset & 0xff);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            if (extra >= 15) length(extra - 15);
+
+            ip += match;
+            anchor = ip;
+        }
+    }
+    literals(anchor, n - anchor, 0);
+    return static_cast<size_t>(op - dst);
+}
+
+/**
+ * @brief Decompresses an LZ4 block.
+ *
+ * @param src The compressed bytes.
+ * @param n The number of compressed bytes.
+ * @param dst Receives the decompressed bytes.
+ * @param capacity The size of dst (the expected decompressed size).
+ * @return size_t The number of decompressed bytes.
+ * @throws std::runtime_error If the block is malformed or does not fit in dst.
+ */
+inline size_t lz_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t capacity) {
+    size_t ip = 0, op = 0;
+    auto length = [&](size_t value) {
+        uint8_t byte = 255;
+        while (byte == 255) {
+            if (ip >= n) throw std::runtime_error("Corrupted compressed block");
+            byte = src[ip++];
+            value += byte;
+        }
+        return value;
+    };
+
+    while (ip < n) {
+        const uint8_t token = src[ip++];
+        size_t count = token >> 4;
+        if (count == 15) count = length(count);
+        if (count > n - ip || count > capacity - op) throw std::runtime_error("Corrupted compressed block");
+        std::memcpy(dst + op, src + ip, count);
+        ip += count;
+        op += count;
+        if (ip == n) break; // the last sequence has no match
+
+        if (n - ip < 2) throw std::runtime_error("Corrupted compressed block");
+        const size_t offset = static_cast<size_t>(src[ip]) | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        size_t match = token & 15;
+        if (match == 15) match = length(match);
+        match += 4;
+        if (offset == 0 || offset > op || match > capacity - op) throw std::runtime_error("Corrupted compressed block");
+
+        uint8_t* out = dst + op;
+        const uint8_t* from = out - offset;
+        if (offset >= match) {
+            std::memcpy(out, from, match);
+        } else {
+            for (size_t i = 0; i < match; ++i) out[i] = from[i]; // overlapping: repeats the last offset bytes
+        }
+        op += match;
+    }
+    return op;
+}
+
+/**
+ * @brief Groups the k-th bytes of n elements of `width` bytes together (plane k = bytes k of every element).
+ *
+ * Floating-point values of a signal share their sign and exponent bytes, so the
+ * planes of the high bytes are long runs that the codec compresses well.
+ */
+inline void byte_shuffle(const uint8_t* in, size_t n, size_t width, uint8_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t b = 0; b < width; ++b) out[b * n + i] = in[i * width + b];
+    }
+}
+
+/**
+ * @brief Inverse of byte_shuffle().
+ */
+inline void byte_unshuffle(const uint8_t* in, size_t n, size_t width, uint8_t* out) {
+    // Sequential writes, `width` sequential read streams
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t b = 0; b < width; ++b) out[i * width + b] = in[b * n + i];
+    }
+}
+
+/**
+ * @brief Widens n stored components of the given format to double.
+ */
+inline void widen_components(const uint8_t* in, size_t n, WireFormat format, double* out) {
+    if (format == WireFormat::Float) {
+        for (size_t i = 0; i < n; ++i) {
+            float f;
+            std::memcpy(&f, in + i * sizeof(float), sizeof(f));
+            out[i] = f;
+        }
+    } else if (format == WireFormat::BFloat16) {
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t h;
+            std::memcpy(&h, in + i * sizeof(uint16_t), sizeof(h));
+            out[i] = bfloat16_to_float(h);
+        }
+    } else {
+        std::memcpy(out, in, n * sizeof(double));
+    }
+}
+
+/**
+ * @brief Fixed-size header at the beginning of a block file (host byte order, little-endian in practice).
+ */
+struct BlockFileHeader {
+    char magic[4] = {'F', 'F', 'T', 'Z'};
+    uint32_t version = 1;
+    uint32_t format = 0;         ///< WireFormat of the stored components.
+    uint32_t real = 0;           ///< 1 if only the real components are stored.
+    uint64_t samples = 0;        ///< Total number of samples.
+    uint64_t block_samples = 0;  ///< Samples per block (the last block may be shorter).
+    uint64_t blocks = 0;         ///< Number of blocks; blocks + 1 offsets follow the header.
+};
+
+/**
+ * @brief Returns the bytes of one stored component in the given format.
+ */
+inline size_t block_component_bytes(WireFormat format) {
+    return wire_bytes_per_value(format) / 2;
+}
+
+/**
+ * @brief Writes samples as a block-compressed file.
+ *
+ * Layout: BlockFileHeader, then blocks + 1 uint64 offsets (block i spans
+ * [offset[i], offset[i+1]) in the file), then the blocks. A block holds the
+ * components of block_samples samples (real parts only for a real signal) in the
+ * given precision, byte-shuffled and LZ4-compressed; a block that does not shrink
+ * is stored shuffled but uncompressed (its size is then the raw size). Blocks are
+ * independent, so they are compressed by the OpenMP threads in parallel.
+ *
+ * @param path The file to create.
+ * @param data The samples.
+ * @param n The number of samples.
+ * @param real If true, only the real parts are stored.
+ * @param format The precision of the stored components.
+ * @param block_samples Samples per block.
+ * @throws std::invalid_argument If block_samples is 0.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+template <typename T>
+void write_block_file(const std::string& path, const T* data, size_t n, bool real,
+                      WireFormat format = WireFormat::Double, size_t block_samples = BLOCK_FILE_SAMPLES) {
+    if (block_samples == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    BlockFileHeader header;
+    header.format = static_cast<uint32_t>(format);
+    header.real = real ? 1 : 0;
+    header.samples = n;
+    header.block_samples = block_samples;
+    header.blocks = (n + block_samples - 1) / block_samples;
+
+    const size_t width = block_component_bytes(format);
+    const size_t per_sample = real ? 1 : 2;
+    std::vector<std::vector<uint8_t>> blocks(header.blocks);
+
+    #pragma omp parallel
+    {
+        std::vector<uint8_t> raw(block_samples * per_sample * width), shuffled(raw.size());
+
+        #pragma omp for schedule(dynamic)
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            const size_t first = b * block_samples;
+            const size_t count = std::min(block_samples, n - first);
+            const size_t components = count * per_sample;
+
+            for (size_t i = 0; i < count; ++i) {
+                const double re = data[first + i].real(), im = data[first + i].imag();
+                for (size_t c = 0; c < per_sample; ++c) {
+                    const double value = c == 0 ? re : im;
+                    uint8_t* slot = raw.data() + (i * per_sample + c) * width;
+                    if (format == WireFormat::Float) {
+                        const float f = static_cast<float>(value);
+                        std::memcpy(slot, &f, sizeof(f));
+                    } else if (format == WireFormat::BFloat16) {
+                        const uint16_t h = float_to_bfloat16(static_cast<float>(value));
+                        std::memcpy(slot, &h, sizeof(h));
+                    } else {
+                        std::memcpy(slot, &value, sizeof(value));
+                    }
+                }
+            }
+            byte_shuffle(raw.data(), components, width, shuffled.data());
+
+            const size_t raw_bytes = components * width;
+            std::vector<uint8_t>& out = blocks[b];
+            out.resize(lz_bound(raw_bytes));
+            const size_t packed = lz_compress(shuffled.data(), raw_bytes, out.data());
+            if (packed < raw_bytes) {
+                out.resize(packed);
+            } else {
+                out.assign(shuffled.begin(), shuffled.begin() + static_cast<std::ptrdiff_t>(raw_bytes));
+            }
+        }
+    }
+
+    std::vector<uint64_t> offsets(header.blocks + 1);
+    offsets[0] = sizeof(header) + offsets.size() * sizeof(uint64_t);
+    for (size_t b = 0; b < blocks.size(); ++b) offsets[b + 1] = offsets[b] + blocks[b].size();
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+    for (const auto& block : blocks) file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+    if (!file) {
+        throw std::runtime_error("Could not write file");
+    }
+}
+
+/**
+ * @brief Reads the header of a block file.
+ * @throws std::runtime_error If the file cannot be opened or is not a block file.
+ */
+inline BlockFileHeader read_block_header(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    BlockFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, "FFTZ", 4) != 0 || header.version != 1 ||
+        header.format > static_cast<uint32_t>(WireFormat::BFloat16) || header.block_samples == 0 ||
+        header.blocks != (header.samples + header.block_samples - 1) / header.block_samples) {
+        throw std::runtime_error("Not a block-compressed sample file");
+    }
+    return header;
+}
+
+/**
+ * @brief Returns true if the file starts with the block file magic.
+ */
+inline bool is_block_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {0, 0, 0, 0};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, "FFTZ", 4) == 0;
+}
+
+/**
+ * @brief Decompresses every block of a block file straight into the destination samples.
+ *
+ * The threads take blocks dynamically: each one reads its block with pread(),
+ * decompresses it into a private buffer, then unshuffles and widens the components
+ * into the destination slice of the block (imaginary parts are 0 for a real file).
+ *
+ * @param path The block file.
+ * @param out Receives header.samples values.
+ * @param threads The number of OpenMP threads (0 = the OpenMP default).
+ * @return BlockFileHeader The header of the file.
+ * @throws std::runtime_error If the file cannot be read or a block is corrupted.
+ */
+template <typename T>
+BlockFileHeader read_block_file(const std::string& path, T* out, int threads = 0) {
+    const BlockFileHeader header = read_block_header(path);
+    const size_t blocks = static_cast<size_t>(header.blocks);
+    const WireFormat format = static_cast<WireFormat>(header.format);
+    const size_t width = block_component_bytes(format);
+    const size_t per_sample = header.real ? 1 : 2;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file");
+    }
+    std::vector<uint64_t> offsets(blocks + 1);
+    const size_t index_bytes = offsets.size() * sizeof(uint64_t);
+    if (::pread(fd, offsets.data(), index_bytes, sizeof(header)) != static_cast<ssize_t>(index_bytes)) {
+        ::close(fd);
+        throw std::runtime_error("Not a block-compressed sample file");
+    }
+
+    bool failed = false;
+    #pragma omp parallel num_threads(threads > 0 ? threads : omp_get_max_threads()) reduction(|| : failed)
+    {
+        std::vector<uint8_t> packed, shuffled(header.block_samples * per_sample * width), raw(shuffled.size());
+        std::vector<double> values(header.block_samples * per_sample);
+
+        #pragma omp for schedule(dynamic)
+        for (size_t b = 0; b < blocks; ++b) {
+            if (failed) continue;
+            const size_t first = b * header.block_samples;
+            const size_t count = std::min<size_t>(header.block_samples, header.samples - first);
+            const size_t components = count * per_sample;
+            const size_t raw_bytes = components * width;
+            if (offsets[b + 1] < offsets[b] || offsets[b + 1] - offsets[b] > lz_bound(raw_bytes)) {
+                failed = true;
+                continue;
+            }
+            const size_t stored = static_cast<size_t>(offsets[b + 1] - offsets[b]);
+
+            // A block that did not shrink was stored shuffled but uncompressed
+            uint8_t* source = stored == raw_bytes ? shuffled.data() : (packed.resize(stored), packed.data());
+            if (::pread(fd, source, stored, static_cast<off_t>(offsets[b])) != static_cast<ssize_t>(stored)) {
+                failed = true;
+                continue;
+            }
+            try {
+                if (stored != raw_bytes && lz_decompress(packed.data(), stored, shuffled.data(), raw_bytes) != raw_bytes) {
+                    failed = true;
+                    continue;
+                }
+            } catch (const std::runtime_error&) {
+                failed = true;
+                continue;
+            }
+            T* destination = out + first;
+            if (format == WireFormat::Double && !header.real && sizeof(T) == 2 * sizeof(double)) {
+                // Interleaved complex doubles: the unshuffled bytes are the samples themselves
+                byte_unshuffle(shuffled.data(), components, width, reinterpret_cast<uint8_t*>(destination));
+                continue;
+            }
+            byte_unshuffle(shuffled.data(), components, width, raw.data());
+            widen_components(raw.data(), components, format, values.data());
+            for (size_t i = 0; i < count; ++i) {
+                destination[i] = header.real ? T(values[i], 0.0) : T(values[2 * i], values[2 * i + 1]);
+            }
+        }
+    }
+    ::close(fd);
+    if (failed) {
+        throw std::runtime_error("Corrupted compressed block");
+    }
+    return header;
+}
+
+#endif // BLOCK_FILE_HPP
@@ -0,0 +1,398 @@
+/**
+ * @file Communicator.hpp
+ * @brief Communication backends for the distributed FFT algorithm: MPI processes
+ * or threads sharing one address space.
+ */
+#ifndef COMMUNICATOR_HPP
+#define COMMUNICATOR_HPP
+
+#include <mpi.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class Communicator
+ * @brief Abstract interface of the collectives used by the distributed algorithm.
+ *
+ * Every participant ("rank") owns one Communicator and all of them must call the
+ * collectives in the same order.
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class Communicator {
+    public:
+        /**
+         * @brief Virtual destructor.
+         */
+        virtual ~Communicator() {}
+
+        /**
+         * @brief Returns the rank of this participant.
+         */
+        virtual int rank() const = 0;
+
+        /**
+         * @brief Returns the number of participants.
+         */
+        virtual int size() const = 0;
+
+        /**
+         * @brief Sends a value from root to every participant.
+         * @param value The value (input on root, output elsewhere).
+         * @param root The sending rank.
+         */
+        virtual void broadcast(size_t& value, int root) = 0;
+
+        /**
+         * @brief Distributes consecutive blocks of count elements from root.
+         * @param send size() * count elements (root only).
+         * @param recv Receives the count elements of this rank.
+         * @param count The block length.
+         * @param root The sending rank.
+         */
+        virtual void scatter(const T* send, T* recv, int count, int root) = 0;
+
+        /**
+         * @brief Collects count elements of every rank, in rank order, on root.
+         * @param send The count elements of this rank.
+         * @param recv Receives size() * count elements (root only).
+         * @param count The block length.
+         * @param root The receiving rank.
+         */
+        virtual void gather(const T* send, T* recv, int count, int root) = 0;
+
+        /**
+         * @brief Exchanges count elements with a partner (pairwise, both call it).
+         * @param send The elements to send.
+         * @param recv Receives the partner's elements.
+         * @param count The number of elements.
+         * @param partner The partner rank.
+         */
+        virtual void sendrecv(const T* send, T* recv, int count, int partner) = 0;
+
+        /**
+         * @brief Sends block j of send to rank j and receives block i of rank i into block i of recv.
+         * @param send size() * count elements.
+         * @param recv size() * count elements.
+         * @param count The block length.
+         */
+        virtual void alltoall(const T* send, T* recv, int count) = 0;
+
+        /**
+         * @brief scatter() of count values of value_bytes bytes each (e.g. values in a compressed wire format).
+         * @param send size() * count values (root only).
+         * @param recv Receives the count values of this rank.
+         * @param count The block length, in values.
+         * @param value_bytes The size of one value.
+         * @param root The sending rank.
+         */
+        virtual void scatter_values(const void* send, void* recv, int count, size_t value_bytes, int root) = 0;
+
+        /**
+         * @brief gather() of count values of value_bytes bytes each.
+         * @param send The count values of this rank.
+         * @param recv Receives size() * count values (root only).
+         * @param count The block length, in values.
+         * @param value_bytes The size of one value.
+         * @param root The receiving rank.
+         */
+        virtual void gather_values(const void* send, void* recv, int count, size_t value_bytes, int root) = 0;
+
+        /**
+         * @brief sendrecv() of count values of value_bytes bytes each.
+         * @param send The values to send.
+         * @param recv Receives the partner's values.
+         * @param count The number of values.
+         * @param value_bytes The size of one value.
+         * @param partner The partner rank.
+         */
+        virtual void sendrecv_values(const void* send, void* recv, int count, size_t value_bytes, int partner) = 0;
+
+        /**
+         * @brief Sums value over every participant on root.
+         * @param value The contribution of this rank; the sum on root (unchanged elsewhere).
+         * @param root The receiving rank.
+         */
+        virtual void reduce_sum(long long& value, int root) = 0;
+
+        /**
+         * @brief Waits until every participant reached the barrier.
+         */
+        virtual void barrier() = 0;
+};
+
+/**
+ * @class MpiCommunicator
+ * @brief Communicator backed by an MPI communicator (one participant per process).
+ */
+template <typename T>
+class MpiCommunicator : public Communicator<T> {
+    private:
+        MPI_Comm comm;
+        int my_rank;
+        int my_size;
+
+    public:
+        /**
+         * @brief Wraps an MPI communicator.
+         * @param communicator The MPI communicator to use (default: MPI_COMM_WORLD).
+         */
+        MpiCommunicator(MPI_Comm communicator = MPI_COMM_WORLD) : comm(communicator) {
+            MPI_Comm_rank(comm, &my_rank);
+            MPI_Comm_size(comm, &my_size);
+        }
+
+        int rank() const override { return my_rank; }
+
+        int size() const override { return my_size; }
+
+        void broadcast(size_t& value, int root) override {
+            unsigned long long v = value;
+            MPI_Bcast(&v, 1, MPI_UNSIGNED_LONG_LONG, root, comm);
+            value = static_cast<size_t>(v);
+        }
+
+        void scatter(const T* send, T* recv, int count, int root) override {
+            MPI_Scatter(send, count, MPI_C_DOUBLE_COMPLEX, recv, count, MPI_C_DOUBLE_COMPLEX, root, comm);
+        }
+
+        void gather(const T* send, T* recv, int count, int root) override {
+            MPI_Gather(send, count, MPI_C_DOUBLE_COMPLEX, recv, count, MPI_C_DOUBLE_COMPLEX, root, comm);
+        }
+
+        void sendrecv(const T* send, T* recv, int count, int partner) override {
+            MPI_Sendrecv(send, count, MPI_C_DOUBLE_COMPLEX, partner, 0,
+                         recv, count, MPI_C_DOUBLE_COMPLEX, partner, 0,
+                         comm, MPI_STATUS_IGNORE);
+        }
+
+        void alltoall(const T* send, T* recv, int count) override {
+            MPI_Alltoall(send, count, MPI_C_DOUBLE_COMPLEX, recv, count, MPI_C_DOUBLE_COMPLEX, comm);
+        }
+
+        void scatter_values(const void* send, void* recv, int count, size_t value_bytes, int root) override {
+            MPI_Datatype type = value_type(value_bytes);
+            MPI_Scatter(send, count, type, recv, count, type, root, comm);
+            MPI_Type_free(&type);
+        }
+
+        void gather_values(const void* send, void* recv, int count, size_t value_bytes, int root) override {
+            MPI_Datatype type = value_type(value_bytes);
+            MPI_Gather(send, count, type, recv, count, type, root, comm);
+            MPI_Type_free(&type);
+        }
+
+        void sendrecv_values(const void* send, void* recv, int count, size_t value_bytes, int partner) override {
+            MPI_Datatype type = value_type(value_bytes);
+            MPI_Sendrecv(send, count, type, partner, 0, recv, count, type, partner, 0, comm, MPI_STATUS_IGNORE);
+            MPI_Type_free(&type);
+        }
+
+        void reduce_sum(long long& value, int root) override {
+            long long sum = 0;
+            MPI_Reduce(&value, &sum, 1, MPI_LONG_LONG, MPI_SUM, root, comm);
+            if (my_rank == root) value = sum;
+        }
+
+        void barrier() override {
+            MPI_Barrier(comm);
+        }
+
+    private:
+        /**
+         * @brief Returns a committed datatype of value_bytes contiguous bytes (free it with MPI_Type_free).
+         */
+        static MPI_Datatype value_type(size_t value_bytes) {
+            MPI_Datatype type;
+            MPI_Type_contiguous(static_cast<int>(value_bytes), MPI_BYTE, &type);
+            MPI_Type_commit(&type);
+            return type;
+        }
+};
+
+/**
+ * @class ThreadTeam
+ * @brief State shared by the threads of one ThreadCommunicator group.
+ *
+ * Holds a reusable barrier and one published pointer per thread: collectives
+ * exchange pointers to the callers' buffers and copy straight from/to them,
+ * without intermediate message buffers.
+ */
+class ThreadTeam {
+    private:
+        int count;
+        int waiting = 0;
+        unsigned long generation = 0;
+        std::mutex mutex;
+        std::condition_variable released;
+
+    public:
+        /**
+         * @brief Pointer published by every thread for the current collective.
+         */
+        std::vector<const void*> slots;
+
+        /**
+         * @brief Value published by the root of a broadcast.
+         */
+        size_t shared_value = 0;
+
+        /**
+         * @brief Contributions of every thread to a reduction.
+         */
+        std::vector<long long> contributions;
+
+        /**
+         * @brief Creates the shared state of a group of threads.
+         * @param threads The number of threads of the group.
+         */
+        explicit ThreadTeam(int threads) : count(threads), slots(threads, nullptr), contributions(threads, 0) {}
+
+        /**
+         * @brief Returns the number of threads of the group.
+         */
+        int size() const { return count; }
+
+        /**
+         * @brief Blocks until all the threads of the group called it (reusable).
+         */
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            unsigned long my_generation = generation;
+            if (++waiting == count) {
+                waiting = 0;
+                ++generation;
+                released.notify_all();
+            } else {
+                released.wait(lock, [&] { return generation != my_generation; });
+            }
+        }
+};
+
+/**
+ * @class ThreadCommunicator
+ * @brief Communicator between threads of one process sharing memory.
+ *
+ * Each collective publishes pointers in the ThreadTeam, synchronizes, copies the
+ * needed data directly from the peers' buffers and synchronizes again so that
+ * no buffer is reused while a peer is still reading it.
+ */
+template <typename T>
+class ThreadCommunicator : public Communicator<T> {
+    private:
+        ThreadTeam& team;
+        int my_rank;
+
+    public:
+        /**
+         * @brief Creates the endpoint of thread my_rank in team.
+         * @param shared The state shared by the group.
+         * @param thread_rank The rank of the calling thread (0 .. shared.size()-1).
+         */
+        ThreadCommunicator(ThreadTeam& shared, int thread_rank) : team(shared), my_rank(thread_rank) {}
+
+        int rank() const override { return my_rank; }
+
+        int size() const override { return team.size(); }
+
+        void broadcast(size_t& value, int root) override {
+            if (my_rank == root) team.shared_value = value;
+            team.wait();
+            value = team.shared_value;
+            team.wait();
+        }
+
+        void scatter(const T* send, T* recv, int count, int root) override {
+            if (my_rank == root) team.slots[root] = send;
+            team.wait();
+            const T* source = static_cast<const T*>(team.slots[root]) + static_cast<size_t>(my_rank) * count;
+            std::copy(source, source + count, recv);
+            team.wait();
+        }
+
+        void gather(const T* send, T* recv, int count, int root) override {
+            if (my_rank == root) team.slots[root] = recv;
+            team.wait();
+            T* target = const_cast<T*>(static_cast<const T*>(team.slots[root])) + static_cast<size_t>(my_rank) * count;
+            std::copy(send, send + count, target);
+            team.wait();
+        }
+
+        void sendrecv(const T* send, T* recv, int count, int partner) override {
+            team.slots[my_rank] = send;
+            team.wait();
+            const T* source = static_cast<const T*>(team.slots[partner]);
+            std::copy(source, source + count, recv);
+            team.wait();
+        }
+
+        void alltoall(const T* send, T* recv, int count) override {
+            team.slots[my_rank] = send;
+            team.wait();
+            for (int peer = 0; peer < team.size(); ++peer) {
+                const T* source = static_cast<const T*>(team.slots[peer]) + static_cast<size_t>(my_rank) * count;
+                std::copy(source, source + count, recv + static_cast<size_t>(peer) * count);
+            }
+            team.wait();
+        }
+
+        void scatter_values(const void* send, void* recv, int count, size_t value_bytes, int root) override {
+            scatter(static_cast<const unsigned char*>(send), static_cast<unsigned char*>(recv), count * value_bytes, root);
+        }
+
+        void gather_values(const void* send, void* recv, int count, size_t value_bytes, int root) override {
+            gather(static_cast<const unsigned char*>(send), static_cast<unsigned char*>(recv), count * value_bytes, root);
+        }
+
+        void sendrecv_values(const void* send, void* recv, int count, size_t value_bytes, int partner) override {
+            team.slots[my_rank] = send;
+            team.wait();
+            const unsigned char* source = static_cast<const unsigned char*>(team.slots[partner]);
+            std::copy(source, source + count * value_bytes, static_cast<unsigned char*>(recv));
+            team.wait();
+        }
+
+        void reduce_sum(long long& value, int root) override {
+            team.contributions[my_rank] = value;
+            team.wait();
+            if (my_rank == root) {
+                long long sum = 0;
+                for (long long contribution : team.contributions) sum += contribution;
+                value = sum;
+            }
+            team.wait();
+        }
+
+        void barrier() override {
+            team.wait();
+        }
+
+    private:
+        /**
+         * @brief scatter() of bytes blocks of raw bytes.
+         */
+        void scatter(const unsigned char* send, unsigned char* recv, size_t bytes, int root) {
+            if (my_rank == root) team.slots[root] = send;
+            team.wait();
+            const unsigned char* source = static_cast<const unsigned char*>(team.slots[root]) + static_cast<size_t>(my_rank) * bytes;
+            std::copy(source, source + bytes, recv);
+            team.wait();
+        }
+
+        /**
+         * @brief gather() of bytes blocks of raw bytes.
+         */
+        void gather(const unsigned char* send, unsigned char* recv, size_t bytes, int root) {
+            if (my_rank == root) team.slots[root] = recv;
+            team.wait();
+            unsigned char* target = const_cast<unsigned char*>(static_cast<const unsigned char*>(team.slots[root])) + static_cast<size_t>(my_rank) * bytes;
+            std::copy(send, send + bytes, target);
+            team.wait();
+        }
+};
+
+#endif // COMMUNICATOR_HPP
@@ -0,0 +1,287 @@
+/**
+ * @file Composed.hpp
+ * @brief Header file for the FFT engine composed from compile-time policies.
+ */
+
+#ifndef COMPOSED_HPP
+#define COMPOSED_HPP
+
+#include "Fourier.hpp"
+#include "Kernels.hpp"
+#include "../utilities/Timer.hpp"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Execution policy: plain sequential loops.
+ */
+struct Sequential {
+    /**
+     * @brief Calls body(i) for i = 0 .. count-1.
+     */
+    template <typename Body>
+    static void for_each(size_t count, Body&& body) {
+        for (size_t i = 0; i < count; ++i) body(i);
+    }
+};
+
+/**
+ * @brief Execution policy: loops shared among the OpenMP threads.
+ */
+struct OpenMP {
+    /**
+     * @brief Calls body(i) for i = 0 .. count-1 in an OpenMP parallel loop.
+     */
+    template <typename Body>
+    static void for_each(size_t count, Body&& body) {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; ++i) body(i);
+    }
+};
+
+/**
+ * @brief Permutation policy: out-of-place bit-reversal copy (input to output).
+ */
+struct BitReversalCopy {
+    /**
+     * @brief Writes in[i] to out[rev(i)] for the n elements.
+     */
+    template <typename Execution, typename T>
+    static void apply(const T* in, T* out, size_t n) {
+        size_t log_n = 0;
+        while ((size_t(1) << log_n) < n) log_n++;
+
+        Execution::for_each(n, [&](size_t i) {
+            size_t j = 0;
+            size_t bits = i;
+            for (size_t bit = 0; bit < log_n; ++bit) {
+                j = (j << 1) | (bits & 1);
+                bits >>= 1;
+            }
+            out[j] = in[i];
+        });
+    }
+};
+
+/**
+ * @brief Stage kernel policy: twiddles by recurrence (w *= wlen), one group of butterflies per iteration.
+ *
+ * No tables, like Iterative; parallelism comes from the groups, so the last stages
+ * (few large groups) run on few threads.
+ */
+struct RecurrenceStages {
+    /**
+     * @brief Nothing to prepare.
+     */
+    void prepare(size_t) {}
+
+    /**
+     * @brief Runs every butterfly stage on the bit-reversed data.
+     */
+    template <typename Execution, typename T>
+    void apply(T* data, size_t n, bool inverse) const {
+        for (size_t len = 2; len <= n; len <<= 1) {
+            double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
+            const T wlen(std::cos(angle), std::sin(angle));
+            const size_t half = len / 2;
+
+            Execution::for_each(n / len, [&](size_t group) {
+                T* block = data + group * len;
+                T w(1.0, 0.0);
+                for (size_t j = 0; j < half; ++j) {
+                    T u = block[j];
+                    T v = block[j + half] * w;
+                    block[j] = u + v;
+                    block[j + half] = u - v;
+                    w *= wlen;
+                }
+            });
+        }
+    }
+};
+
+/**
+ * @brief Stage kernel policy: tabulated twiddles, one butterfly per iteration.
+ *
+ * Every stage is a single flat loop over the n/2 butterflies, so all stages expose
+ * the same parallelism; the table is rebuilt only when n changes.
+ *
+ * @tparam T The data type of the signal: the table holds twiddles of the same precision.
+ */
+template <typename T>
+struct TwiddleTableStages {
+    /**
+     * @brief make_twiddles(n) of the last prepared length.
+     */
+    std::vector<T> twiddles;
+
+    /**
+     * @brief Builds the twiddle table for length n (kept across calls with the same n).
+     */
+    void prepare(size_t n) {
+        if (twiddles.size() != n / 2) twiddles = make_twiddles<T>(n);
+    }
+
+    /**
+     * @brief Runs every butterfly stage on the bit-reversed data.
+     */
+    template <typename Execution>
+    void apply(T* data, size_t n, bool inverse) const {
+        const T* table = twiddles.data();
+        for (size_t len = 2; len <= n; len <<= 1) {
+            const size_t half = len / 2;
+            const size_t stride = n / len;
+
+            Execution::for_each(n / 2, [&](size_t b) {
+                size_t j = b % half;
+                T* u_ptr = data + (b / half) * len + j;
+                T w = inverse ? std::conj(table[j * stride]) : table[j * stride];
+                T u = u_ptr[0];
+                T v = u_ptr[half] * w;
+                u_ptr[0] = u + v;
+                u_ptr[half] = u - v;
+            });
+        }
+    }
+};
+
+/**
+ * @brief Normalization policy: 1/n on the inverse transform only (the convention of the other engines).
+ */
+struct NormalizeInverse {
+    /**
+     * @brief Returns the factor applied to the result (1 means no pass over the data).
+     */
+    static double factor(size_t n, bool inverse) {
+        return inverse ? 1.0 / static_cast<double>(n) : 1.0;
+    }
+};
+
+/**
+ * @brief Normalization policy: 1/sqrt(n) on both transforms (unitary DFT).
+ */
+struct NormalizeUnitary {
+    /**
+     * @brief Returns the factor applied to the result.
+     */
+    static double factor(size_t n, bool) {
+        return 1.0 / std::sqrt(static_cast<double>(n));
+    }
+};
+
+/**
+ * @brief Normalization policy: no scaling (the inverse returns n times the signal).
+ */
+struct Unnormalized {
+    /**
+     * @brief Returns the factor applied to the result.
+     */
+    static double factor(size_t, bool) {
+        return 1.0;
+    }
+};
+
+/**
+ * @class Composed
+ * @brief Radix-2 FFT engine assembled at compile time from four policies.
+ *
+ * The phases (permutation, butterfly stages, normalization) and the way their loops
+ * run are template parameters instead of virtual calls, so for a fixed configuration
+ * the compiler sees the whole transform and can inline across the phases. transform()
+ * is the non-virtual entry point for hot paths; compute()/reverseCompute() are the
+ * thin Fourier wrappers used by main and the other engines.
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ * @tparam Permutation Reorders the input, e.g. BitReversalCopy.
+ * @tparam Stages Butterfly stage kernel, e.g. RecurrenceStages or TwiddleTableStages<T>.
+ * @tparam Normalization Scaling of the result, e.g. NormalizeInverse.
+ * @tparam Execution Loop execution, Sequential or OpenMP.
+ */
+template <typename T,
+          typename Permutation = BitReversalCopy,
+          typename Stages = TwiddleTableStages<T>,
+          typename Normalization = NormalizeInverse,
+          typename Execution = OpenMP>
+class Composed : public Fourier<T> {
+    private:
+        Stages stages;
+
+        /**
+        * @brief Transforms the input into the output buffer and measures it.
+        * @param inverse If true, computes the inverse FFT.
+        * @throws std::invalid_argument If the input size is not a power of 2.
+        */
+        void execute(bool inverse) {
+            size_t n = this->input->size();
+            if (n == 0) return;
+            if ((n & (n - 1)) != 0) {
+                throw std::invalid_argument("Input size must be a power of 2");
+            }
+
+            Timer t;
+
+            transform(this->input->data(), this->prepare_output(n), n, inverse);
+
+            this->record_duration(t, n, inverse);
+        }
+
+    public:
+        /**
+         * @brief Computes the transform of n elements of in into out (non-virtual, inlinable).
+         * @param in Pointer to the n input elements (must not overlap out).
+         * @param out Pointer to the n output elements.
+         * @param n The transform length (a power of 2).
+         * @param inverse If true, uses positive angles.
+         */
+        void transform(const T* in, T* out, size_t n, bool inverse) {
+            stages.prepare(n);
+            Permutation::template apply<Execution>(in, out, n);
+            stages.template apply<Execution>(out, n, inverse);
+
+            const double scale = Normalization::factor(n, inverse);
+            if (scale != 1.0) {
+                Execution::for_each(n, [&](size_t i) { out[i] *= scale; });
+            }
+        }
+
+        /**
+         * @brief Computes the forward Fast Fourier Transform.
+         */
+        void compute() override {
+            execute(false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the inverse Fast Fourier Transform.
+         */
+        void reverseCompute() override {
+            execute(true); // inverse = true
+        }
+
+        /**
+         * @brief Prints the statistics of the Composed FFT/IFFT execution.
+         * @param label "FFT" or "IFFT"
+         */
+        void printStats(const std::string& label) override {
+            std::cout << "Composed " << label << " Duration: " << this->duration << " ms" << std::endl;
+        }
+};
+
+/**
+ * @brief Sequential engine equivalent to Iterative, with every phase inlined.
+ */
+template <typename T>
+using SerialComposed = Composed<T, BitReversalCopy, RecurrenceStages, NormalizeInverse, Sequential>;
+
+/**
+ * @brief Threaded engine: tabulated twiddles and flat per-stage loops under OpenMP.
+ */
+template <typename T>
+using ThreadedComposed = Composed<T, BitReversalCopy, TwiddleTableStages<T>, NormalizeInverse, OpenMP>;
+
+#endif // COMPOSED_HPP
@@ -0,0 +1,125 @@
+/**
+ * @file Compression.hpp
+ * @brief Reduced-precision wire formats for the data exchanged between ranks.
+ */
+
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Representation of each real component while it travels between ranks.
+ */
+enum class WireFormat {
+    Double,   ///< Lossless, 16 bytes per complex value.
+    Float,    ///< Cast to float, 8 bytes per complex value (relative error <= 2^-24).
+    BFloat16  ///< Upper half of the float (bf16), 4 bytes per complex value (relative error <= 2^-8).
+};
+
+/**
+ * @brief Returns the number of bytes of one complex value in the given format.
+ */
+inline size_t wire_bytes_per_value(WireFormat format) {
+    switch (format) {
+        case WireFormat::Float:    return 2 * sizeof(float);
+        case WireFormat::BFloat16: return 2 * sizeof(uint16_t);
+        default:                   return 2 * sizeof(double);
+    }
+}
+
+/**
+ * @brief Returns the cheapest format whose relative rounding error stays within the bound.
+ * @param relative_error The accepted relative error per component (0 means lossless).
+ */
+inline WireFormat wire_format_for_error(double relative_error) {
+    if (relative_error >= 1.0 / 256.0) return WireFormat::BFloat16;
+    if (relative_error >= 1.0 / 16777216.0) return WireFormat::Float;
+    return WireFormat::Double;
+}
+
+/**
+ * @brief Converts a float to bf16 with round-to-nearest-even.
+ */
+inline uint16_t float_to_bfloat16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // NaN must stay NaN after truncation
+    if ((bits & 0x7f800000u) == 0x7f800000u && (bits & 0x007fffffu) != 0) {
+        return static_cast<uint16_t>((bits >> 16) | 0x0040u);
+    }
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+/**
+ * @brief Expands a bf16 value to float.
+ */
+inline float bfloat16_to_float(uint16_t value) {
+    uint32_t bits = static_cast<uint32_t>(value) << 16;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/**
+ * @brief Encodes n complex values in the given wire format.
+ * @param in Pointer to the values.
+ * @param n The number of values.
+ * @param format The wire format.
+ * @param out Resized to n * wire_bytes_per_value(format) bytes and filled.
+ */
+template <typename T>
+void pack_wire(const T* in, size_t n, WireFormat format, std::vector<unsigned char>& out) {
+    out.resize(n * wire_bytes_per_value(format));
+
+    if (format == WireFormat::Float) {
+        float* dst = reinterpret_cast<float*>(out.data());
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            dst[2 * i] = static_cast<float>(in[i].real());
+            dst[2 * i + 1] = static_cast<float>(in[i].imag());
+        }
+    } else if (format == WireFormat::BFloat16) {
+        uint16_t* dst = reinterpret_cast<uint16_t*>(out.data());
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            dst[2 * i] = float_to_bfloat16(static_cast<float>(in[i].real()));
+            dst[2 * i + 1] = float_to_bfloat16(static_cast<float>(in[i].imag()));
+        }
+    } else {
+        std::memcpy(out.data(), in, n * sizeof(T));
+    }
+}
+
+/**
+ * @brief Decodes n complex values from the given wire format.
+ * @param in The encoded bytes.
+ * @param n The number of values.
+ * @param format The wire format.
+ * @param out Pointer to n values to overwrite.
+ */
+template <typename T>
+void unpack_wire(const unsigned char* in, size_t n, WireFormat format, T* out) {
+    if (format == WireFormat::Float) {
+        const float* src = reinterpret_cast<const float*>(in);
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = T(src[2 * i], src[2 * i + 1]);
+        }
+    } else if (format == WireFormat::BFloat16) {
+        const uint16_t* src = reinterpret_cast<const uint16_t*>(in);
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = T(bfloat16_to_float(src[2 * i]), bfloat16_to_float(src[2 * i + 1]));
+        }
+    } else {
+        std::memcpy(out, in, n * sizeof(T));
+    }
+}
+
+#endif // COMPRESSION_HPP
@@ -0,0 +1,193 @@
+/**
+ * @file ConstantQ.hpp
+ * @brief Header file for the constant-Q transform with precomputed sparse spectral kernels.
+ */
+#ifndef CONSTANT_Q_HPP
+#define CONSTANT_Q_HPP
+
+#include "Kernels.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parameters of the constant-Q transform.
+ */
+struct ConstantQConfig {
+    double sample_rate = 44100.0; ///< Samples per second of the audio.
+    double fmin = 32.70;          ///< Centre frequency of the first bin in Hz (C1 by default).
+    size_t bins_per_octave = 12;  ///< Frequency resolution (12 = semitones).
+    size_t bins = 84;             ///< Number of bins (84 = 7 octaves of semitones).
+    size_t hop = 512;             ///< Samples between the starts of consecutive frames.
+    double threshold = 0.0054;    ///< Spectral kernel values below this magnitude are dropped.
+};
+
+/**
+ * @class ConstantQ
+ * @brief Constant-Q transform of audio: log-spaced bins with a constant frequency-to-bandwidth ratio.
+ *
+ * Bin k is centred on fmin * 2^(k / bins_per_octave) and correlates the frame with a
+ * Hann-windowed complex exponential of Q cycles (Q = 1 / (2^(1/bins_per_octave) - 1)),
+ * so low bins use long windows and high bins short ones. Following Brown and Puckette,
+ * the correlations are computed in the frequency domain: the FFTs of the temporal
+ * kernels are computed once per configuration, and their values below the threshold
+ * are dropped, which leaves a few non-zeros per bin around its centre frequency.
+ * Every frame then costs one real FFT (length: the power of 2 above the longest
+ * kernel) plus a sparse matrix-vector product over the positive frequencies.
+ * Frames are shared among the OpenMP threads.
+ *
+ * @tparam T The complex data type (usually std::complex<double>).
+ */
+template <typename T>
+class ConstantQ : public TimedTransform {
+    private:
+        ConstantQConfig config;
+        size_t fft_n; ///< Frame and FFT length (power of 2).
+
+        DftKernel<T> half_kernel;
+        std::vector<T> twiddles; ///< exp(-2*pi*i*k/fft_n) for k = 0 .. fft_n/2.
+
+        /**
+         * @brief Sparse spectral kernels (CSR): bin k uses entries offset[k] .. offset[k+1].
+         */
+        std::vector<size_t> offset, index;
+        std::vector<T> values; ///< conj(K_k[j]) / fft_n.
+
+        /**
+        * @brief Computes the spectral kernels and keeps their significant positive-frequency values.
+        */
+        void build_kernels() {
+            const double pi = std::acos(-1.0);
+            const double q = 1.0 / (std::pow(2.0, 1.0 / static_cast<double>(config.bins_per_octave)) - 1.0);
+            const std::vector<T> full_twiddles = make_twiddles<T>(fft_n);
+            std::vector<T> kernel(fft_n);
+
+            offset.assign(1, 0);
+            for (size_t k = 0; k < config.bins; ++k) {
+                const size_t length = window_length(k, q);
+                const size_t start = (fft_n - length) / 2; // centred in the frame
+
+                std::fill(kernel.begin(), kernel.end(), T(0));
+                for (size_t i = 0; i < length; ++i) {
+                    const double hann = 0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / static_cast<double>(length));
+                    kernel[start + i] = std::polar(hann / static_cast<double>(length),
+                                                   2.0 * pi * q * static_cast<double>(i) / static_cast<double>(length));
+                }
+                fft_in_place(kernel.data(), fft_n, full_twiddles, false);
+
+                // Negative frequencies of the kernel are negligible: only the real FFT's bins are kept
+                for (size_t j = 0; j <= fft_n / 2; ++j) {
+                    if (std::abs(kernel[j]) > config.threshold) {
+                        index.push_back(j);
+                        values.push_back(std::conj(kernel[j]) / static_cast<double>(fft_n));
+                    }
+                }
+                offset.push_back(index.size());
+            }
+        }
+
+        /**
+        * @brief Returns the window length of bin k: Q periods of its centre frequency.
+        */
+        size_t window_length(size_t k, double q) const {
+            const double frequency = config.fmin * std::pow(2.0, static_cast<double>(k) / static_cast<double>(config.bins_per_octave));
+            return static_cast<size_t>(std::ceil(q * config.sample_rate / frequency));
+        }
+
+    public:
+        /**
+         * @brief Precomputes the sparse spectral kernels of the configuration.
+         * @param cfg The parameters of the transform.
+         * @throws std::invalid_argument If there are no bins, the hop is 0, or the highest
+         *         bin is not below the Nyquist frequency.
+         */
+        explicit ConstantQ(const ConstantQConfig& cfg)
+            : TimedTransform("ConstantQ", false), config(cfg), fft_n(2), half_kernel(1) {
+            if (cfg.bins == 0 || cfg.bins_per_octave == 0 || cfg.hop == 0 || cfg.fmin <= 0.0) {
+                throw std::invalid_argument("Bins, bins per octave, hop and minimum frequency must be positive");
+            }
+            const double top = cfg.fmin * std::pow(2.0, static_cast<double>(cfg.bins - 1) / static_cast<double>(cfg.bins_per_octave));
+            if (top >= cfg.sample_rate / 2.0) {
+                throw std::invalid_argument("Highest bin must be below the Nyquist frequency");
+            }
+
+            const double q = 1.0 / (std::pow(2.0, 1.0 / static_cast<double>(cfg.bins_per_octave)) - 1.0);
+            while (fft_n < window_length(0, q)) fft_n <<= 1;
+
+            half_kernel = DftKernel<T>(fft_n / 2);
+            twiddles.resize(fft_n / 2 + 1);
+            for (size_t k = 0; k <= fft_n / 2; ++k) {
+                twiddles[k] = std::polar(1.0, -2.0 * std::acos(-1.0) * static_cast<double>(k) / static_cast<double>(fft_n));
+            }
+
+            build_kernels();
+        }
+
+        /**
+         * @brief Returns the frame (FFT) length.
+         */
+        size_t frameLength() const {
+            return fft_n;
+        }
+
+        /**
+         * @brief Returns the number of complete frames in count samples.
+         */
+        size_t frames(size_t count) const {
+            return count < fft_n ? 0 : 1 + (count - fft_n) / config.hop;
+        }
+
+        /**
+         * @brief Returns the number of non-zero values of the spectral kernels.
+         */
+        size_t kernelSize() const {
+            return values.size();
+        }
+
+        /**
+         * @brief Returns the centre frequency of bin k in Hz.
+         */
+        double frequency(size_t k) const {
+            return config.fmin * std::pow(2.0, static_cast<double>(k) / static_cast<double>(config.bins_per_octave));
+        }
+
+        /**
+         * @brief Computes the constant-Q coefficients of every complete frame.
+         * @param samples The audio samples.
+         * @param count The number of samples.
+         * @param out Receives frames(count) x bins coefficients, row-major.
+         */
+        void compute(const double* samples, size_t count, T* out) {
+            Timer t;
+            const size_t n_frames = frames(count);
+
+            #pragma omp parallel
+            {
+                std::vector<T> z(fft_n / 2), scratch(half_kernel.scratch_size()), spectrum(fft_n / 2 + 1);
+
+                #pragma omp for schedule(static)
+                for (size_t f = 0; f < n_frames; ++f) {
+                    real_forward(samples + f * config.hop, fft_n, half_kernel, twiddles.data(),
+                                 z.data(), scratch.data(), spectrum.data());
+
+                    T* row = out + f * config.bins;
+                    for (size_t k = 0; k < config.bins; ++k) {
+                        T sum(0.0);
+                        for (size_t e = offset[k]; e < offset[k + 1]; ++e) sum += spectrum[index[e]] * values[e];
+                        row[k] = sum;
+                    }
+                }
+            }
+
+            this->record_duration(t, n_frames);
+        }
+};
+
+#endif // CONSTANT_Q_HPP
@@ -0,0 +1,263 @@
+/**
+ * @file CrossSpectral.hpp
+ * @brief Header file for the cross-spectral density and coherence matrices of sensor arrays.
+ */
+#ifndef CROSS_SPECTRAL_HPP
+#define CROSS_SPECTRAL_HPP
+
+#include "Kernels.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parameters of the Welch estimate.
+ */
+struct CrossSpectralConfig {
+    size_t segment = 256;     ///< Samples per segment (even), also the FFT length.
+    size_t overlap = 128;     ///< Samples shared by consecutive segments (less than segment).
+    double sample_rate = 1.0; ///< Samples per second (scales the densities to units^2/Hz).
+    size_t batch = 32;        ///< Segments transformed before each accumulation pass.
+};
+
+/**
+ * @class CrossSpectral
+ * @brief C x C cross-spectral density matrix per frequency bin, averaged over segments (Welch).
+ *
+ * The signals are cut into Hann-windowed overlapping segments, and every segment of
+ * every channel goes through a real FFT. For each bin f the estimate is
+ *   S(f) = scale * sum over segments of X(f) X(f)^H
+ * with X(f) the column of the C channel spectra, i.e. a Hermitian rank-k update. It
+ * is computed like a GEMM: `batch` segments are transformed at once and laid out bin
+ * by bin as C x batch matrices, then every bin accumulates the product tile by tile
+ * (tiles of channel rows that stay in cache), with contiguous dot products along the
+ * segments. Only the upper triangle (i <= j) is computed and stored, since
+ * S(f)[j][i] = conj(S(f)[i][j]). FFTs are shared among the OpenMP threads by
+ * (channel, segment), accumulations by bin.
+ *
+ * The densities are one-sided (doubled except at DC and Nyquist) and scaled by
+ * 1 / (segments * sample_rate * sum(window^2)), like scipy.signal.csd.
+ *
+ * @tparam T The complex data type (usually std::complex<double>).
+ */
+template <typename T>
+class CrossSpectral : public TimedTransform {
+    private:
+        size_t channels;
+        CrossSpectralConfig config;
+        size_t bins;     ///< segment / 2 + 1.
+        size_t packed;   ///< channels * (channels + 1) / 2 values per bin.
+        size_t averaged; ///< Segments in the last estimate.
+
+        DftKernel<T> half_kernel;
+        std::vector<T> twiddles;    ///< exp(-2*pi*i*k/segment) for k = 0 .. segment/2.
+        std::vector<double> window; ///< Periodic Hann window.
+
+        /**
+         * @brief Upper triangles of the bins, bin after bin (row-major within a bin).
+         */
+        std::vector<T> density;
+
+        static constexpr size_t TILE = 16; ///< Channel rows per accumulation tile.
+
+        /**
+        * @brief Position of (i, j), i <= j, in the upper triangle of a bin.
+        */
+        size_t triangle(size_t i, size_t j) const {
+            return i * channels - i * (i - 1) / 2 + (j - i);
+        }
+
+        /**
+        * @brief Computes the four sums over b of x_r[b] * conj(y_c[b]) for two rows x and two rows y.
+        */
+        static void dot2x2(const T* x0, const T* x1, const T* y0, const T* y1, size_t count, T (&sum)[2][2]) {
+            double re00 = 0.0, im00 = 0.0, re01 = 0.0, im01 = 0.0;
+            double re10 = 0.0, im10 = 0.0, re11 = 0.0, im11 = 0.0;
+            for (size_t b = 0; b < count; ++b) {
+                const double ar = x0[b].real(), ai = x0[b].imag();
+                const double br = x1[b].real(), bi = x1[b].imag();
+                const double cr = y0[b].real(), ci = y0[b].imag();
+                const double dr = y1[b].real(), di = y1[b].imag();
+                re00 += ar * cr + ai * ci;  im00 += ai * cr - ar * ci;
+                re01 += ar * dr + ai * di;  im01 += ai * dr - ar * di;
+                re10 += br * cr + bi * ci;  im10 += bi * cr - br * ci;
+                re11 += br * dr + bi * di;  im11 += bi * dr - br * di;
+            }
+            sum[0][0] = T(re00, im00);
+            sum[0][1] = T(re01, im01);
+            sum[1][0] = T(re10, im10);
+            sum[1][1] = T(re11, im11);
+        }
+
+        /**
+        * @brief Adds the spectra of `count` segments (laid out [bin][channel][segment]) to the density.
+        */
+        void accumulate(const T* spectra, size_t count) {
+            #pragma omp parallel for schedule(static)
+            for (size_t f = 0; f < bins; ++f) {
+                const T* a = spectra + f * channels * config.batch;
+                T* s = density.data() + f * packed;
+
+                for (size_t i0 = 0; i0 < channels; i0 += TILE) {
+                    const size_t i1 = std::min(channels, i0 + TILE);
+                    for (size_t j0 = i0; j0 < channels; j0 += TILE) {
+                        const size_t j1 = std::min(channels, j0 + TILE);
+                        // 2 x 2 blocks of (i, j): every loaded value feeds two products
+                        for (size_t i = i0; i < i1; i += 2) {
+                            const bool pair_i = i + 1 < i1;
+                            for (size_t j = (j0 == i0 ? i : j0); j < j1; j += 2) {
+                                const bool pair_j = j + 1 < j1;
+                                T sum[2][2];
+                                dot2x2(a + i * config.batch, a + (pair_i ? i + 1 : i) * config.batch,
+                                       a + j * config.batch, a + (pair_j ? j + 1 : j) * config.batch, count, sum);
+                                for (size_t di = 0; di < (pair_i ? 2u : 1u); ++di) {
+                                    for (size_t dj = 0; dj < (pair_j ? 2u : 1u); ++dj) {
+                                        if (i + di <= j + dj) s[triangle(i + di, j + dj)] += sum[di][dj];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        /**
+         * @brief Prepares the estimate for the given number of channels.
+         * @param n_channels The number of channels C.
+         * @param cfg The parameters of the Welch estimate.
+         * @throws std::invalid_argument If there are no channels, the segment is odd or
+         *         smaller than 2, the overlap is not below the segment, or the batch is 0.
+         */
+        CrossSpectral(size_t n_channels, const CrossSpectralConfig& cfg)
+            : TimedTransform("CrossSpectral", false), channels(n_channels), config(cfg),
+              bins(cfg.segment / 2 + 1), packed(n_channels * (n_channels + 1) / 2), averaged(0),
+              half_kernel(cfg.segment >= 2 ? cfg.segment / 2 : 1) {
+            if (n_channels == 0) {
+                throw std::invalid_argument("At least one channel is needed");
+            }
+            if (cfg.segment < 2 || cfg.segment % 2 != 0 || cfg.overlap >= cfg.segment) {
+                throw std::invalid_argument("Segment must be even and longer than the overlap");
+            }
+            if (cfg.batch == 0) {
+                throw std::invalid_argument("Batch must be positive");
+            }
+
+            const double pi = std::acos(-1.0);
+            twiddles.resize(bins);
+            window.resize(config.segment);
+            for (size_t k = 0; k < bins; ++k) {
+                twiddles[k] = std::polar(1.0, -2.0 * pi * static_cast<double>(k) / static_cast<double>(config.segment));
+            }
+            for (size_t i = 0; i < config.segment; ++i) {
+                window[i] = 0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / static_cast<double>(config.segment));
+            }
+        }
+
+        /**
+         * @brief Returns the number of complete segments in signals of the given length.
+         */
+        size_t segments(size_t samples) const {
+            const size_t hop = config.segment - config.overlap;
+            return samples < config.segment ? 0 : 1 + (samples - config.segment) / hop;
+        }
+
+        /**
+         * @brief Returns the number of frequency bins (segment / 2 + 1).
+         */
+        size_t frequencyBins() const {
+            return bins;
+        }
+
+        /**
+         * @brief Estimates the cross-spectral density matrices.
+         * @param data channels x samples values, one channel after the other.
+         * @param samples The number of samples per channel.
+         */
+        void compute(const double* data, size_t samples) {
+            Timer t;
+            const size_t hop = config.segment - config.overlap;
+            const size_t total = segments(samples);
+            density.assign(bins * packed, T(0.0));
+
+            std::vector<T> spectra(bins * channels * config.batch);
+            for (size_t first = 0; first < total; first += config.batch) {
+                const size_t count = std::min(config.batch, total - first);
+
+                // Channel FFTs of the batch, stored [bin][channel][segment]
+                #pragma omp parallel
+                {
+                    std::vector<double> windowed(config.segment);
+                    std::vector<T> z(config.segment / 2), scratch(half_kernel.scratch_size()), spectrum(bins);
+
+                    #pragma omp for collapse(2) schedule(static)
+                    for (size_t c = 0; c < channels; ++c) {
+                        for (size_t b = 0; b < count; ++b) {
+                            const double* x = data + c * samples + (first + b) * hop;
+                            for (size_t i = 0; i < config.segment; ++i) windowed[i] = x[i] * window[i];
+                            real_forward(windowed.data(), config.segment, half_kernel, twiddles.data(),
+                                         z.data(), scratch.data(), spectrum.data());
+                            for (size_t f = 0; f < bins; ++f) {
+                                spectra[(f * channels + c) * config.batch + b] = spectrum[f];
+                            }
+                        }
+                    }
+                }
+
+                accumulate(spectra.data(), count);
+            }
+
+            // One-sided density scaling
+            double power = 0.0;
+            for (double w : window) power += w * w;
+            const double scale = total == 0 ? 0.0 : 1.0 / (static_cast<double>(total) * config.sample_rate * power);
+            #pragma omp parallel for schedule(static)
+            for (size_t f = 0; f < bins; ++f) {
+                const double factor = (f == 0 || f == bins - 1) ? scale : 2.0 * scale;
+                for (size_t p = 0; p < packed; ++p) density[f * packed + p] *= factor;
+            }
+            averaged = total;
+
+            this->record_duration(t, total);
+        }
+
+        /**
+         * @brief Returns S(f)[i][j], the cross-spectral density of channels i and j at bin f.
+         */
+        T csd(size_t f, size_t i, size_t j) const {
+            return i <= j ? density[f * packed + triangle(i, j)] : std::conj(density[f * packed + triangle(j, i)]);
+        }
+
+        /**
+         * @brief Returns the magnitude-squared coherence |S_ij|^2 / (S_ii * S_jj) at bin f (0 if a channel is silent).
+         */
+        double coherence(size_t f, size_t i, size_t j) const {
+            const double sii = density[f * packed + triangle(i, i)].real();
+            const double sjj = density[f * packed + triangle(j, j)].real();
+            return sii > 0.0 && sjj > 0.0 ? std::norm(csd(f, i, j)) / (sii * sjj) : 0.0;
+        }
+
+        /**
+         * @brief Returns the upper triangles of all bins (bin after bin, row-major, i <= j).
+         */
+        const std::vector<T>& matrices() const {
+            return density;
+        }
+
+        /**
+         * @brief Returns the number of segments averaged by the last compute().
+         */
+        size_t averagedSegments() const {
+            return averaged;
+        }
+};
+
+#endif // CROSS_SPECTRAL_HPP
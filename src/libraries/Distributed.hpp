@@ -0,0 +1,195 @@
+/**
+ * @file Distributed.hpp
+ * @brief Header file for the backend-independent distributed FFT implementation.
+ */
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include "Fourier.hpp"
+#include "Communicator.hpp"
+#include "Parallel.hpp"
+#include "../utilities/Timer.hpp"
+#include <mpi.h>
+#include <algorithm>
+#include <complex>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Where the participants of the distributed algorithm run.
+ */
+enum class Backend {
+    MPI,     ///< One participant per MPI process (MpiCommunicator).
+    Threads  ///< Participants are threads of this process (ThreadCommunicator).
+};
+
+/**
+ * @class Distributed
+ * @brief Runs the Parallel binary-exchange algorithm on a selectable Communicator backend.
+ *
+ * Every participant runs one Parallel engine built on its Communicator: rank 0
+ * shares this object's input and output destination (vector or mapOutput() file)
+ * with its engine, which writes the result there directly. With
+ * Backend::Threads the participants are threads exchanging pointers in shared
+ * memory, so the distributed algorithm can be run and benchmarked inside one
+ * process, without mpirun.
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class Distributed : public Fourier<T> {
+    private:
+        Backend backend;
+
+        /**
+         * @brief Number of threads of Backend::Threads.
+         */
+        int ranks;
+
+        /**
+         * @brief The MPI communicator of Backend::MPI.
+         */
+        MPI_Comm comm;
+
+        /**
+        * @brief Runs one transform on the engine of this participant.
+        * @param engine The Parallel engine of this participant.
+        * @param root True for rank 0, which owns the input and the output.
+        * @param inverse If true, computes the inverse FFT.
+        */
+        void run(Parallel<T>& engine, bool root, bool inverse) {
+            if (root) {
+                engine.shareInput(this->input, this->real_input);
+                this->lend_output(engine);
+            }
+
+            if (inverse) {
+                engine.reverseCompute();
+            } else {
+                engine.compute();
+            }
+
+            if (root) this->take_output(engine);
+        }
+
+        /**
+        * @brief Runs the algorithm on the selected backend and measures it.
+        * @param inverse If true, computes the inverse FFT.
+        * @throws std::invalid_argument (Backend::Threads) If the input size is not a power of 2
+        *         and a multiple of the number of threads; checked before any thread starts.
+        */
+        void execute(bool inverse) {
+            Timer t;
+
+            if (backend == Backend::MPI) {
+                Parallel<T> engine(comm);
+                run(engine, is_root(), inverse);
+            } else {
+                const size_t n = this->input->size();
+                if (n == 0) {
+                    this->prepare_output(0);
+                    this->record_duration(t, 0, inverse);
+                    return;
+                }
+                if ((n & (n - 1)) != 0 || n % ranks != 0) {
+                    throw std::invalid_argument("Input size must be a power of 2 and a multiple of the number of ranks");
+                }
+
+                ThreadTeam team(ranks);
+                std::vector<std::unique_ptr<Parallel<T>>> engines;
+                for (int r = 0; r < ranks; ++r) {
+                    engines.emplace_back(new Parallel<T>(std::unique_ptr<Communicator<T>>(new ThreadCommunicator<T>(team, r))));
+                }
+
+                // An exception must not escape a std::thread: keep it and rethrow after the join
+                std::vector<std::exception_ptr> errors(ranks);
+                std::vector<std::thread> workers;
+                workers.reserve(ranks);
+#ifdef _OPENMP
+                // Share the OpenMP threads among the participants
+                int threads_per_rank = std::max(1, omp_get_max_threads() / ranks);
+#endif
+                for (int r = 0; r < ranks; ++r) {
+                    workers.emplace_back([&, r] {
+                        try {
+#ifdef _OPENMP
+                            omp_set_num_threads(threads_per_rank);
+#endif
+                            run(*engines[r], r == 0, inverse);
+                        } catch (...) {
+                            errors[r] = std::current_exception();
+                        }
+                    });
+                }
+                for (std::thread& worker : workers) {
+                    worker.join();
+                }
+
+                for (const std::exception_ptr& error : errors) {
+                    if (error) std::rethrow_exception(error);
+                }
+            }
+
+            this->record_duration(t, this->output_size(), inverse);
+        }
+
+        /**
+        * @brief Returns true if this participant prints (rank 0 of the backend).
+        */
+        bool is_root() const {
+            if (backend == Backend::Threads) return true;
+            int rank = 0;
+            MPI_Comm_rank(comm, &rank);
+            return rank == 0;
+        }
+
+    public:
+        /**
+         * @brief Constructs a Distributed FFT object.
+         *
+         * @param kind The communication backend.
+         * @param threads The number of participants of Backend::Threads (a power of 2).
+         * @param communicator The MPI communicator of Backend::MPI (default: MPI_COMM_WORLD).
+         * @throws std::invalid_argument If threads is not a positive power of 2.
+         */
+        Distributed(Backend kind = Backend::Threads, int threads = 4, MPI_Comm communicator = MPI_COMM_WORLD)
+            : backend(kind), ranks(threads), comm(communicator) {
+            if (threads <= 0 || (threads & (threads - 1)) != 0) {
+                throw std::invalid_argument("The number of threads must be a power of 2");
+            }
+        }
+
+        /**
+         * @brief Computes the forward Fast Fourier Transform on the selected backend.
+         */
+        void compute() override {
+            execute(false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the inverse Fast Fourier Transform on the selected backend.
+         */
+        void reverseCompute() override {
+            execute(true); // inverse = true
+        }
+
+        /**
+         * @brief Prints the statistics of the Distributed FFT/IFFT execution.
+         * @param label "FFT" or "IFFT"
+         */
+        void printStats(const std::string& label) override {
+            if (is_root()) {
+                std::cout << "Distributed " << label << " Duration: " << this->duration << " ms" << std::endl;
+            }
+        }
+};
+
+#endif // DISTRIBUTED_HPP
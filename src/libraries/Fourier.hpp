@@ -6,12 +6,17 @@
 #ifndef FOURIER_HPP
 #define FOURIER_HPP
 
+#include "BlockFile.hpp"
+#include "../utilities/LatencyHistogram.hpp"
+#include "../utilities/MappedFile.hpp"
+#include "../utilities/Timer.hpp"
 #include <vector>
 #include <string>
 #include <fstream>
 #include <iomanip>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 using namespace std;
 
@@ -28,9 +33,9 @@ template <typename T>
 class Fourier {
     protected:
         /**
-         * @brief Pointer to the input data vector.
+         * @brief Pointer to the input data vector, read-only for the transforms (may be shared, see shareInput()).
          */
-        unique_ptr<vector<T>> input;
+        shared_ptr<const vector<T>> input;
 
         /**
          * @brief Pointer to the output data vector.
@@ -42,13 +47,123 @@ class Fourier {
          */
         long long duration;
 
+        /**
+         * @brief Latencies of every forward and inverse transform, by size.
+         */
+        LatencyRecorder forward_latency, inverse_latency;
+
+        /**
+         * @brief True if the last read() detected a purely real signal.
+         */
+        bool real_input;
+
+        /**
+         * @brief Path of the file the results are mapped to (empty = output vector).
+         */
+        string mapped_path;
+
+        /**
+         * @brief The mapped results, if mapOutput() was called and a transform ran.
+         */
+        unique_ptr<MappedFile<T>> mapped_output;
+
+        /**
+         * @brief Stops the timer of a transform: sets duration and records the latency.
+         * @param t The timer started at the beginning of the transform.
+         * @param n The transform size.
+         * @param inverse True for reverseCompute().
+         */
+        void record_duration(Timer& t, size_t n, bool inverse) {
+            const long long ns = t.stop_and_return_ns();
+            duration = ns / 1000000;
+            (inverse ? inverse_latency : forward_latency).record(n, ns);
+        }
+
+        /**
+         * @brief Prepares the destination of n results and returns it.
+         *
+         * Engines write their final stage through the returned pointer: it is either the
+         * output vector (resized to n) or, after mapOutput(), the memory-mapped file.
+         *
+         * @param n The number of results.
+         * @return T* Where the n results must be written.
+         */
+        T* prepare_output(size_t n) {
+            if (!mapped_path.empty()) {
+                if (mapped_output == nullptr || mapped_output->size() != n) {
+                    mapped_output.reset();
+                    mapped_output = make_unique<MappedFile<T>>(mapped_path, n);
+                }
+                output.reset();
+                return mapped_output->data();
+            }
+
+            if (output == nullptr) {
+                output = make_unique<vector<T>>(n);
+            } else {
+                output->resize(n);
+            }
+            return output->data();
+        }
+
+        /**
+         * @brief Returns the results of the last computation (mapped file or output vector), nullptr if none.
+         */
+        T* output_data() const {
+            if (output != nullptr) return output->data();
+            if (mapped_output != nullptr) return mapped_output->data();
+            return nullptr;
+        }
+
+        /**
+         * @brief Returns the number of results of the last computation.
+         */
+        size_t output_size() const {
+            if (output != nullptr) return output->size();
+            if (mapped_output != nullptr) return mapped_output->size();
+            return 0;
+        }
+
+        /**
+         * @brief Hands the output destination of this object (mapped path and open mapping) to engine.
+         *
+         * For wrappers that run another engine: with lend_output() before and take_output()
+         * after, the engine writes its final stage straight into this object's destination.
+         */
+        void lend_output(Fourier<T>& engine) {
+            engine.mapped_path = mapped_path;
+            engine.mapped_output = std::move(mapped_output);
+        }
+
+        /**
+         * @brief Takes the results of engine (output vector or mapping) as this object's results, without a copy.
+         */
+        void take_output(Fourier<T>& engine) {
+            output = std::move(engine.output);
+            mapped_output = std::move(engine.mapped_output);
+        }
+
+        /**
+         * @brief Zero-pads samples to the next power of 2 (with a warning) if needed.
+         * @param samples The samples about to become the input.
+         */
+        static void pad_samples(vector<T>& samples) {
+            size_t n = samples.size();
+            if (n > 0 && (n & (n - 1)) != 0) {
+                size_t next_pow2 = 1;
+                while (next_pow2 < n) next_pow2 <<= 1;
+                samples.resize(next_pow2, T(0));
+                cout << "Warning: Input size " << n << " is not a power of 2. Padded to " << next_pow2 << endl;
+            }
+        }
+
     public:
         /**
          * @brief Default constructor.
          * 
          * Initializes input and output pointers to nullptr and duration to 0.
          */
-        Fourier() : input(nullptr), output(nullptr), duration(0) {}
+        Fourier() : input(nullptr), output(nullptr), duration(0), real_input(false) {}
 
         /**
          * @brief Virtual destructor.
@@ -82,23 +197,42 @@ class Fourier {
             cout << label << " Duration: " << duration << " ms" << endl;
         }
 
+        /**
+         * @brief Prints the latency percentiles of every transform run so far, by size.
+         * @param name The engine name, e.g. "Iterative".
+         */
+        void printLatency(const std::string& name) const {
+            forward_latency.report(name + " FFT");
+            inverse_latency.report(name + " IFFT");
+        }
+
+        /**
+         * @brief Returns the latencies of the forward (or inverse) transforms, by size.
+         * @param inverse True for the reverseCompute() latencies.
+         */
+        const LatencyRecorder& latency(bool inverse = false) const {
+            return inverse ? inverse_latency : forward_latency;
+        }
+
         /**
          * @brief Reads input data from a file.
          * 
          * Reads values from the specified file into the input vector.
          * If the number of elements is not a power of 2, it pads the input with zeros
-         * to the next power of 2.
+         * to the next power of 2 (unless pad is false, for engines of arbitrary length).
          * 
          * @param filename The path to the input file.
+         * @param pad If true, zero-pads the input to the next power of 2.
+         * @return bool True if the file contains real samples, false if it contains complex values.
          * @throws std::runtime_error If the file cannot be opened.
          */
-        bool read(const char* filename) {
+        bool read(const char* filename, bool pad = true) {
             ifstream file(filename);
             if (!file.is_open()) {
                 throw runtime_error("Could not open file");
             }
 
-            input = make_unique<vector<T>>();
+            auto samples = make_shared<vector<T>>();
             T value;
             bool isReal = true;
 
@@ -110,21 +244,38 @@ class Fourier {
             }
 
             while (file >> value) {
-                input->push_back(value);
+                samples->push_back(value);
             }
             file.close();
 
-            // Pad to next power of 2
-            size_t n = input->size();
-            if (n > 0 && (n & (n - 1)) != 0) {
-                size_t next_pow2 = 1;
-                while (next_pow2 < n) next_pow2 <<= 1;
-                input->resize(next_pow2, T(0));
-                cout << "Warning: Input size " << n << " is not a power of 2. Padded to " << next_pow2 << endl;
-            }
+            if (pad) pad_samples(*samples);
+            input = std::move(samples);
+            real_input = isReal;
             return isReal;
         }
 
+        /**
+         * @brief Reads input data from a block-compressed file (see write_block_file()).
+         *
+         * The blocks are decompressed by the OpenMP threads in parallel, each one
+         * straight into its slice of the input buffer. Padding works as in read().
+         *
+         * @param filename The path to the block file.
+         * @param pad If true, zero-pads the input to the next power of 2.
+         * @return bool True if the file stores a real signal, false if it stores complex values.
+         * @throws std::runtime_error If the file cannot be opened or is corrupted.
+         */
+        bool readCompressed(const char* filename, bool pad = true) {
+            const BlockFileHeader header = read_block_header(filename);
+            auto samples = make_shared<vector<T>>(static_cast<size_t>(header.samples));
+            read_block_file(filename, samples->data());
+
+            if (pad) pad_samples(*samples);
+            input = std::move(samples);
+            real_input = header.real != 0;
+            return real_input;
+        }
+
         /**
          * @brief Writes output data to a file.
          * 
@@ -134,7 +285,8 @@ class Fourier {
          * @throws std::runtime_error If the output data is empty or the file cannot be opened.
          */
         void write(const char* filename) {
-            if (output == nullptr) {
+            const T* results = output_data();
+            if (results == nullptr) {
                 throw runtime_error("Output data is empty");
             }
 
@@ -144,8 +296,8 @@ class Fourier {
             }
 
             file << fixed << setprecision(6);
-            for (const auto& value : *output) {
-                file << value << endl;
+            for (size_t i = 0; i < output_size(); ++i) {
+                file << results[i] << endl;
             }
             file.close();
         }
@@ -160,7 +312,8 @@ class Fourier {
          * @throws std::runtime_error If the output data is empty or the file cannot be opened.
          */
         void writeReal(const char* filename) {
-            if (output == nullptr) {
+            const T* results = output_data();
+            if (results == nullptr) {
                 throw runtime_error("Output data is empty");
             }
 
@@ -170,25 +323,129 @@ class Fourier {
             }
 
             file << fixed << setprecision(6);
-            for (const auto& value : *output) {
-                file << value.real() << endl;
+            for (size_t i = 0; i < output_size(); ++i) {
+                file << results[i].real() << endl;
             }
             file.close();
         }
 
+        /**
+         * @brief Writes output data to a block-compressed file (see write_block_file()).
+         *
+         * @param filename The path to the output file.
+         * @param format The precision of the stored values (Double is lossless).
+         * @param block_samples Samples per independently compressed block.
+         * @throws std::runtime_error If the output data is empty or the file cannot be written.
+         */
+        void writeCompressed(const char* filename, WireFormat format = WireFormat::Double, size_t block_samples = BLOCK_FILE_SAMPLES) {
+            const T* results = output_data();
+            if (results == nullptr) {
+                throw runtime_error("Output data is empty");
+            }
+            write_block_file(filename, results, output_size(), false, format, block_samples);
+        }
+
+        /**
+         * @brief Writes the input samples to a block-compressed file, e.g. to archive a text input.
+         *
+         * Only the real parts are stored if the last read detected a real signal.
+         *
+         * @param filename The path to the output file.
+         * @param format The precision of the stored values (Double is lossless).
+         * @param block_samples Samples per independently compressed block.
+         * @throws std::runtime_error If the input data is empty or the file cannot be written.
+         */
+        void archiveInput(const char* filename, WireFormat format = WireFormat::Double, size_t block_samples = BLOCK_FILE_SAMPLES) {
+            if (input == nullptr) {
+                throw runtime_error("Input data is empty");
+            }
+            write_block_file(filename, input->data(), input->size(), real_input, format, block_samples);
+        }
+
+        /**
+         * @brief Replaces the input buffer with the given samples.
+         *
+         * Lets an engine be driven from memory (e.g. as the node-local kernel of a
+         * distributed engine) instead of reading a file. The samples are treated as
+         * complex: the real-signal flag of a previous read() is cleared.
+         *
+         * @param data The samples, moved into the engine.
+         */
+        void setInput(vector<T> data) {
+            input = make_shared<const vector<T>>(std::move(data));
+            real_input = false;
+        }
+
+        /**
+         * @brief Uses the given samples as input without copying them.
+         *
+         * Several engines can share one buffer, e.g. to compare them on the same parsed
+         * input: the transforms only read it, and read(), setInput() and
+         * reuseOutputAsInput() replace the pointer instead of writing through it.
+         *
+         * @param data The samples (not padded).
+         * @param real True if the samples are a real signal.
+         */
+        void shareInput(shared_ptr<const vector<T>> data, bool real) {
+            input = std::move(data);
+            real_input = real;
+        }
+
+        /**
+         * @brief Returns the result of the last computation.
+         * @return const vector<T>& The output buffer.
+         * @throws std::runtime_error If the output data is empty.
+         */
+        const vector<T>& getOutput() const {
+            if (output == nullptr) {
+                throw runtime_error("Output data is empty");
+            }
+            return *output;
+        }
+
         /**
          * @brief Copies the current output buffer back into the input buffer.
          *
          * Useful to run IFFT right after FFT without writing/reading from disk.
+         * A spectrum is complex: the real-signal flag of the previous input is cleared.
          *
          * @throws std::runtime_error If the output data is empty.
          */
         void reuseOutputAsInput() {
-            if (output == nullptr) {
+            const T* results = output_data();
+            if (results == nullptr) {
                 throw runtime_error("Output data is empty");
             }
 
-            input = make_unique<vector<T>>(*output);
+            input = make_shared<const vector<T>>(results, results + output_size());
+            real_input = false;
+        }
+
+        /**
+         * @brief Makes the following transforms write their results straight into a file.
+         *
+         * The file is created (or truncated) with room for the results, mapped into memory
+         * and passed to the engine as its output buffer, so the final stage stores the
+         * spectrum directly in the page cache of the file: no output vector and no
+         * serialization pass. The file holds the raw values (for std::complex<double>,
+         * interleaved real and imaginary doubles). On distributed engines only rank 0,
+         * which assembles the result, creates the file.
+         *
+         * @param filename The path of the binary output file.
+         */
+        void mapOutput(const char* filename) {
+            mapped_path = filename;
+            mapped_output.reset();
+        }
+
+        /**
+         * @brief Flushes and closes the mapped output file; following transforms use the output vector again.
+         *
+         * The results stay in the file only: call reuseOutputAsInput() first if they are still needed.
+         */
+        void unmapOutput() {
+            mapped_path.clear();
+            mapped_output.reset();
         }
 };
 
@@ -0,0 +1,158 @@
+/**
+ * @file Hilbert.hpp
+ * @brief Header file for the analytic signal (Hilbert transform) and envelope engine.
+ */
+#ifndef HILBERT_HPP
+#define HILBERT_HPP
+
+#include "Kernels.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class AnalyticSignal
+ * @brief Analytic signal x + i*H(x) and envelope |x + i*H(x)| of real signals of length n.
+ *
+ * One fused in-memory pass per signal: a real-input forward FFT (packed half-length
+ * transform for even n), the one-sided mask (DC and Nyquist kept, positive frequencies
+ * doubled, negative frequencies zeroed) and an inverse FFT of length n, all in the
+ * output buffer. The imaginary part of the result is the Hilbert transform H(x).
+ * Any length works; signals of a batch are shared among the OpenMP threads.
+ *
+ * @tparam T The complex data type (usually std::complex<double>).
+ */
+template <typename T>
+class AnalyticSignal : public TimedTransform {
+    private:
+        size_t n;
+
+        /**
+         * @brief True if n is even: the forward FFT uses the packed half-length kernel.
+         */
+        bool packed;
+
+        /**
+         * @brief Kernels of length n/2 (packed forward) and n (odd forward, inverse).
+         */
+        DftKernel<T> half_kernel, kernel;
+
+        /**
+         * @brief exp(-2*pi*i*k/n) for k = 0 .. n/2 (post-processing of the packed FFT).
+         */
+        std::vector<T> twiddles;
+
+        /**
+         * @brief Per-thread buffers of one signal.
+         */
+        struct Workspace {
+            std::vector<T> z, half_scratch, scratch;
+        };
+
+        /**
+        * @brief Allocates the buffers used by analytic() in one thread.
+        */
+        Workspace make_workspace() const {
+            Workspace w;
+            w.z.resize(packed ? n / 2 : 0);
+            w.half_scratch.resize(packed ? half_kernel.scratch_size() : 0);
+            w.scratch.resize(kernel.scratch_size());
+            return w;
+        }
+
+        /**
+        * @brief Computes the analytic signal of n real samples into out (n values).
+        */
+        void analytic(const double* x, T* out, Workspace& w) const {
+            if (packed) {
+                real_forward(x, n, half_kernel, twiddles.data(), w.z.data(), w.half_scratch.data(), out);
+            } else {
+                for (size_t k = 0; k < n; ++k) out[k] = T(x[k], 0.0);
+                kernel(out, w.scratch.data());
+            }
+
+            // One-sided spectrum: X[0] and X[n/2] (even n) kept, 1 .. ceil(n/2)-1 doubled, the rest zeroed.
+            // Conjugated on the way so that the forward kernel computes the inverse.
+            out[0] = std::conj(out[0]);
+            for (size_t k = 1; k < (n + 1) / 2; ++k) out[k] = std::conj(2.0 * out[k]);
+            if (n % 2 == 0) out[n / 2] = std::conj(out[n / 2]);
+            for (size_t k = n / 2 + 1; k < n; ++k) out[k] = T(0.0);
+
+            kernel(out, w.scratch.data());
+            const double scale = 1.0 / static_cast<double>(n);
+            for (size_t k = 0; k < n; ++k) out[k] = std::conj(out[k]) * scale;
+        }
+
+    public:
+        /**
+         * @brief Prepares the transforms of signals of the given length.
+         * @param length The number of samples per signal.
+         * @throws std::invalid_argument If the length is 0.
+         */
+        explicit AnalyticSignal(size_t length)
+            : TimedTransform("Hilbert", false), n(length), packed(length >= 2 && length % 2 == 0),
+              half_kernel(packed ? length / 2 : 1), kernel(length == 0 ? 1 : length) {
+            if (length == 0) {
+                throw std::invalid_argument("Signal length must be positive");
+            }
+            if (packed) {
+                twiddles.resize(n / 2 + 1);
+                double angle = -2.0 * std::acos(-1.0) / static_cast<double>(n);
+                for (size_t k = 0; k <= n / 2; ++k) {
+                    twiddles[k] = std::polar(1.0, angle * static_cast<double>(k));
+                }
+            }
+        }
+
+        /**
+         * @brief Computes the analytic signals of count real signals stored back to back.
+         * @param in count * n real samples.
+         * @param out Receives count * n complex values (real part = input, imaginary part = Hilbert transform).
+         * @param count The number of signals (default 1).
+         */
+        void compute(const double* in, T* out, size_t count = 1) {
+            Timer t;
+
+            #pragma omp parallel if (count > 1)
+            {
+                Workspace w = make_workspace();
+                #pragma omp for schedule(static)
+                for (size_t s = 0; s < count; ++s) {
+                    analytic(in + s * n, out + s * n, w);
+                }
+            }
+
+            this->record_duration(t, n);
+        }
+
+        /**
+         * @brief Computes the envelopes (magnitudes of the analytic signals) of count real signals.
+         * @param in count * n real samples.
+         * @param out Receives count * n envelope values (may be the same buffer as in).
+         * @param count The number of signals (default 1).
+         */
+        void envelope(const double* in, double* out, size_t count = 1) {
+            Timer t;
+
+            #pragma omp parallel if (count > 1)
+            {
+                Workspace w = make_workspace();
+                std::vector<T> signal(n);
+                #pragma omp for schedule(static)
+                for (size_t s = 0; s < count; ++s) {
+                    analytic(in + s * n, signal.data(), w);
+                    for (size_t k = 0; k < n; ++k) out[s * n + k] = std::abs(signal[k]);
+                }
+            }
+
+            this->record_duration(t, n);
+        }
+};
+
+#endif // HILBERT_HPP
@@ -43,14 +43,8 @@ class Iterative : public Fourier<T> {
             size_t log_n = 0;
             while ((size_t(1) << log_n) < n) log_n++;
 
-            // Allocate output if not already allocated
-            if (this->output == nullptr) {
-                this->output = make_unique<vector<T>>(n);
-            } else {
-                if (this->output->size() != n) {
-                    this->output->resize(n);
-                }
-            }
+            // Allocate output if not already allocated (or map it to the output file)
+            T* out = this->prepare_output(n);
 
             for (size_t i = 0; i < n; ++i) {
                 size_t j = 0;
@@ -59,7 +53,7 @@ class Iterative : public Fourier<T> {
                         j |= (size_t(1) << (log_n - 1 - bit));
                     }
                 }
-                (*(this->output))[j] = (*(this->input))[i];
+                out[j] = (*(this->input))[i];
             }
 
             // Butterfly operations
@@ -69,16 +63,16 @@ class Iterative : public Fourier<T> {
                 for (size_t i = 0; i < n; i += len) {
                     std::complex<double> w(1.0, 0.0);
                     for (size_t j = 0; j < len / 2; j++) {
-                        std::complex<double> u = (*(this->output))[i + j];
-                        std::complex<double> v = (*(this->output))[i + j + len / 2] * w;
-                        (*(this->output))[i + j] = u + v;
-                        (*(this->output))[i + j + len / 2] = u - v;
+                        std::complex<double> u = out[i + j];
+                        std::complex<double> v = out[i + j + len / 2] * w;
+                        out[i + j] = u + v;
+                        out[i + j + len / 2] = u - v;
                         w *= wlen;
                     }
                 }
             }
             
-            this->duration = t.stop_and_return();
+            this->record_duration(t, n, false);
         }
 
         /**
@@ -103,14 +97,8 @@ class Iterative : public Fourier<T> {
             size_t log_n = 0;
             while ((size_t(1) << log_n) < n) log_n++;
 
-            // Allocate output if not already allocated
-            if (this->output == nullptr) {
-                this->output = make_unique<vector<T>>(n);
-            } else {
-                if (this->output->size() != n) {
-                    this->output->resize(n);
-                }
-            }
+            // Allocate output if not already allocated (or map it to the output file)
+            T* out = this->prepare_output(n);
 
             for (size_t i = 0; i < n; ++i) {
                 size_t j = 0;
@@ -119,7 +107,7 @@ class Iterative : public Fourier<T> {
                         j |= (size_t(1) << (log_n - 1 - bit));
                     }
                 }
-                (*(this->output))[j] = (*(this->input))[i];
+                out[j] = (*(this->input))[i];
             }
 
             // Butterfly operations
@@ -129,10 +117,10 @@ class Iterative : public Fourier<T> {
                 for (size_t i = 0; i < n; i += len) {
                     std::complex<double> w(1.0, 0.0);
                     for (size_t j = 0; j < len / 2; j++) {
-                        std::complex<double> u = (*(this->output))[i + j];
-                        std::complex<double> v = (*(this->output))[i + j + len / 2] * w;
-                        (*(this->output))[i + j] = u + v;
-                        (*(this->output))[i + j + len / 2] = u - v;
+                        std::complex<double> u = out[i + j];
+                        std::complex<double> v = out[i + j + len / 2] * w;
+                        out[i + j] = u + v;
+                        out[i + j + len / 2] = u - v;
                         w *= wlen;
                     }
                 }
@@ -140,10 +128,10 @@ class Iterative : public Fourier<T> {
 
             // Normalization
             for (size_t i = 0; i < n; ++i) {
-                (*(this->output))[i] /= static_cast<double>(n);
+                out[i] /= static_cast<double>(n);
             }
 
-            this->duration = t.stop_and_return();
+            this->record_duration(t, n, true);
         }
 
          /**
@@ -0,0 +1,723 @@
+/**
+ * @file Kernels.hpp
+ * @brief FFT kernels on raw contiguous buffers, shared by the engines: in-place
+ * transforms of independent blocks (batches, frames, streams) and the butterfly
+ * stages of the distributed engines (per-stage parallel loops or a task dataflow).
+ */
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Precomputes the twiddle factors of an n-point forward FFT.
+ *
+ * twiddles[j] = exp(-2*pi*i*j/n) for j = 0 .. n/2-1. The stage of length len
+ * uses every (n/len)-th entry; the inverse transform uses the conjugates.
+ *
+ * @tparam T The complex data type (usually std::complex<double>).
+ * @param n The transform length (a power of 2).
+ * @return std::vector<T> The n/2 twiddle factors.
+ */
+template <typename T>
+std::vector<T> make_twiddles(size_t n) {
+    std::vector<T> twiddles(n / 2);
+    double angle = -2.0 * std::acos(-1.0) / static_cast<double>(n);
+    for (size_t j = 0; j < n / 2; ++j) {
+        twiddles[j] = std::polar(1.0, angle * static_cast<double>(j));
+    }
+    return twiddles;
+}
+
+/**
+ * @brief Reorders data in place according to the bit-reversal permutation.
+ * @param data Pointer to n contiguous elements.
+ * @param n The number of elements (a power of 2).
+ */
+template <typename T>
+void bit_reverse_permute(T* data, size_t n) {
+    size_t log_n = 0;
+    while ((size_t(1) << log_n) < n) log_n++;
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = 0;
+        for (size_t bit = 0; bit < log_n; ++bit) {
+            if (i & (size_t(1) << bit)) {
+                j |= (size_t(1) << (log_n - 1 - bit));
+            }
+        }
+        // Swap each pair only once
+        if (i < j) std::swap(data[i], data[j]);
+    }
+}
+
+/**
+ * @brief Computes an in-place iterative radix-2 FFT using precomputed twiddles.
+ *
+ * Same algorithm as Iterative (bit-reversal permutation followed by butterfly
+ * stages), but working on a raw buffer so that it can be called on each element
+ * of a batch without allocations.
+ *
+ * @param data Pointer to n contiguous elements, overwritten with the result.
+ * @param n The transform length (a power of 2).
+ * @param twiddles The table returned by make_twiddles(n).
+ * @param inverse If true, computes the normalized inverse FFT.
+ */
+template <typename T>
+void fft_in_place(T* data, size_t n, const std::vector<T>& twiddles, bool inverse) {
+    if (n < 2) return;
+
+    bit_reverse_permute(data, n);
+
+    // Butterfly operations
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t stride = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < len / 2; j++) {
+                T w = inverse ? std::conj(twiddles[j * stride]) : twiddles[j * stride];
+                T u = data[i + j];
+                T v = data[i + j + len / 2] * w;
+                data[i + j] = u + v;
+                data[i + j + len / 2] = u - v;
+            }
+        }
+    }
+
+    // Normalization
+    if (inverse) {
+        for (size_t i = 0; i < n; ++i) {
+            data[i] /= static_cast<double>(n);
+        }
+    }
+}
+
+/**
+ * @brief Performs one stage of the Cooley-Tukey butterfly operations, parallelized with OpenMP.
+ * @param data Pointer to the elements to modify (a whole local block or one of its chunks).
+ * @param local_n The number of elements to process.
+ * @param len The length of the current stage.
+ * @param inverse Whether to perform the inverse FFT stage.
+ */
+template <typename T>
+void butterfly_stage(T* data, size_t local_n, size_t len, bool inverse) {
+    // If inverse is true (inverse FFT), angle is positive. If false, angle is negative.
+    double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
+    std::complex<double> wlen(std::cos(angle), std::sin(angle));
+
+    // Heuristic: if the number of outer iterations is large enough, use the efficient recurrence.
+    // Otherwise (large len), use collapse(2) with direct calculation to maximize parallelism.
+    if (local_n / len >= 32) {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < local_n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (size_t j = 0; j < len / 2; j++) {
+                std::complex<double> u = data[i + j];
+                std::complex<double> v = data[i + j + len / 2] * w;
+
+                // butterfly operation
+                data[i + j] = u + v;
+                data[i + j + len / 2] = u - v;
+
+                // update w
+                w *= wlen;
+            }
+        }
+    } else {
+        #pragma omp parallel for collapse(2) schedule(static)
+        for (size_t i = 0; i < local_n; i += len) {
+            for (size_t j = 0; j < len / 2; j++) {
+                std::complex<double> w = std::polar(1.0, angle * j);
+                std::complex<double> u = data[i + j];
+                std::complex<double> v = data[i + j + len / 2] * w;
+
+                // butterfly operation
+                data[i + j] = u + v;
+                data[i + j + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Default block length of dataflow_stages(): 4096 complex doubles (64 KiB) fit in L2.
+ */
+constexpr size_t DATAFLOW_BLOCK = 4096;
+
+/**
+ * @brief Computes count butterflies between lo[j] and hi[j] with the twiddle of index first_j + j.
+ *
+ * @param lo Pointer to the u halves.
+ * @param hi Pointer to the v halves.
+ * @param count The number of butterflies.
+ * @param first_j The butterfly index j of lo[0] in its stage.
+ * @param len The length of the stage.
+ * @param n The length of the twiddle table's transform.
+ * @param twiddles make_twiddles(n), or nullptr to generate the twiddles by recurrence.
+ * @param inverse Whether to perform the inverse FFT stage.
+ */
+template <typename T>
+void butterfly_span(T* lo, T* hi, size_t count, size_t first_j, size_t len, size_t n,
+                    const T* twiddles, bool inverse) {
+    if (twiddles) {
+        const size_t stride = n / len;
+        for (size_t j = 0; j < count; ++j) {
+            const T& t = twiddles[(first_j + j) * stride];
+            T u = lo[j];
+            T v = hi[j] * (inverse ? std::conj(t) : t);
+            lo[j] = u + v;
+            hi[j] = u - v;
+        }
+        return;
+    }
+    double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
+    std::complex<double> wlen(std::cos(angle), std::sin(angle));
+    std::complex<double> w = std::polar(1.0, angle * static_cast<double>(first_j));
+    for (size_t j = 0; j < count; ++j) {
+        T u = lo[j];
+        T v = hi[j] * w;
+        lo[j] = u + v;
+        hi[j] = u - v;
+        w *= wlen;
+    }
+}
+
+/**
+ * @brief Runs the butterfly stages first_len .. n on bit-reversed data as a dataflow graph of OpenMP tasks.
+ *
+ * butterfly_stage() ends every stage with the barrier of its parallel loop, although
+ * a block only needs two blocks of the previous stage. Here the data is cut into
+ * blocks of the given length: one task per block runs all the stages that fit
+ * inside it, then every cross-block stage has one task per pair of partner blocks,
+ * ordered by depend clauses on the two blocks only. A pair thus starts as soon as
+ * its two inputs are final, while other pairs are still in earlier stages.
+ *
+ * Without twiddles the spans use the same recurrence as butterfly_stage().
+ *
+ * @param data Pointer to n elements, in bit-reversed order, transformed in place.
+ * @param n The number of elements (a power of 2).
+ * @param inverse Whether to perform the inverse FFT stages (not normalized).
+ * @param first_len The length of the first stage to run (smaller stages were already applied).
+ * @param twiddles make_twiddles(n) (or its equivalent), or nullptr.
+ * @param block The block length (a power of 2); blocks >= n run every stage in one task.
+ */
+template <typename T>
+void dataflow_stages(T* data, size_t n, bool inverse, size_t first_len = 2,
+                     const T* twiddles = nullptr, size_t block = DATAFLOW_BLOCK) {
+    if (n < 2 || first_len > n) return;
+    block = std::max<size_t>(2, std::min(block, n));
+
+    // Every stage of the span [i, i + len) that fits inside one block
+    auto inner = [=](T* begin) {
+        for (size_t len = first_len; len <= block; len <<= 1) {
+            for (size_t i = 0; i < block; i += len) {
+                butterfly_span(begin + i, begin + i + len / 2, len / 2, 0, len, n, twiddles, inverse);
+            }
+        }
+    };
+    const size_t blocks = n / block;
+    if (blocks == 1) {
+        inner(data);
+        return;
+    }
+
+    // One dependency token per block: the tasks only read their addresses
+    std::vector<char> ready(blocks);
+    char* token = ready.data();
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        if (first_len <= block) {
+            for (size_t b = 0; b < blocks; ++b) {
+                #pragma omp task depend(out: token[b]) firstprivate(b)
+                inner(data + b * block);
+            }
+        }
+        for (size_t len = std::max(first_len, 2 * block); len <= n; len <<= 1) {
+            const size_t half = len / 2 / block; // Blocks between the two inputs of a butterfly
+            for (size_t b = 0; b < blocks; ++b) {
+                if ((b / half) % 2 != 0) continue;
+                const size_t partner = b + half;
+                #pragma omp task depend(inout: token[b], token[partner]) firstprivate(b, partner, len, half)
+                butterfly_span(data + b * block, data + partner * block, block, (b % half) * block,
+                               len, n, twiddles, inverse);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Second half of a butterfly whose inputs live on two different ranks.
+ *
+ * The lower rank holds u and receives v, the upper rank holds v and receives u;
+ * each one keeps its own half of the result (u + w*v or u - w*v).
+ *
+ * @param local Pointer to count local elements, overwritten with the result.
+ * @param remote Pointer to the matching count elements received from the partner.
+ * @param count The number of elements.
+ * @param first_j The butterfly index j of local[0] (the twiddle is exp(-+2*pi*i*j/len)).
+ * @param len The length of the current stage.
+ * @param is_lower True if this rank holds the u half.
+ * @param inverse Whether to perform the inverse FFT stage.
+ */
+template <typename T>
+void cross_rank_butterfly(T* local, const T* remote, size_t count, size_t first_j, size_t len,
+                          bool is_lower, bool inverse) {
+    // Calculate angle parameters
+    double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < count; ++i) {
+        // Calculate w for this specific index
+        std::complex<double> w = std::polar(1.0, angle * static_cast<double>(first_j + i));
+
+        std::complex<double> u, v;
+        if (is_lower) {
+            // I have u, received v
+            u = local[i];
+            v = remote[i];
+            local[i] = u + v * w;
+        } else {
+            // I have v, received u
+            u = remote[i];
+            v = local[i];
+            local[i] = u - v * w;
+        }
+    }
+}
+
+/**
+ * @brief Computes exp(-i*pi*k^2/n) for k = 0 .. n-1, the chirp of Bluestein's algorithm.
+ *
+ * k^2 is reduced modulo 2n incrementally ((k+1)^2 = k^2 + 2k + 1), so the angle
+ * stays exact even when k^2 would not fit in a double's mantissa.
+ *
+ * @param n The transform length.
+ * @return std::vector<T> The n chirp values.
+ */
+template <typename T>
+std::vector<T> make_chirp(size_t n) {
+    std::vector<T> chirp(n);
+    const double angle = -std::acos(-1.0) / static_cast<double>(n);
+    size_t square = 0; // k^2 mod 2n
+    for (size_t k = 0; k < n; ++k) {
+        chirp[k] = std::polar(1.0, angle * static_cast<double>(square));
+        square = (square + 2 * k + 1) % (2 * n);
+    }
+    return chirp;
+}
+
+template <typename T>
+class DftKernel;
+
+template <typename T>
+class MixedRadixKernel;
+
+/**
+ * @brief Returns the shared mixed-radix plan of length n, building it on first use.
+ *
+ * Plans are immutable once built, so one instance per length serves every kernel,
+ * thread and engine of the process (e.g. the (p-1)-point convolutions of Rader's
+ * algorithm, or the axes of repeated multidimensional transforms).
+ *
+ * @param n The transform length (not a power of 2).
+ * @return std::shared_ptr<const MixedRadixKernel<T>> The cached plan.
+ */
+template <typename T>
+std::shared_ptr<const MixedRadixKernel<T>> mixed_radix_plan(size_t n) {
+    static std::mutex lock;
+    static std::map<size_t, std::shared_ptr<const MixedRadixKernel<T>>> plans;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = plans.find(n);
+        if (found != plans.end()) return found->second;
+    }
+
+    // Built outside the lock: the plan may itself ask for (smaller) cached plans
+    auto plan = std::make_shared<const MixedRadixKernel<T>>(n);
+    std::lock_guard<std::mutex> guard(lock);
+    return plans.emplace(n, plan).first->second;
+}
+
+/**
+ * @class RaderKernel
+ * @brief DFT of prime length p with Rader's algorithm.
+ *
+ * With g a primitive root modulo p, the non-zero indices are permuted so that the DFT
+ * becomes a cyclic convolution of length p - 1:
+ *   X[g^-u] = x[0] + sum over q of x[g^q] * w^(g^(q-u)),   w = exp(-2*pi*i/p),
+ * computed with two FFTs and the precomputed transform of the sequence w^(g^-q). The
+ * convolution runs at length p - 1 when its factors are small, otherwise zero-padded
+ * to a power of 2 of at least 2(p-1) - 1, which avoids nesting Rader's algorithm.
+ */
+template <typename T>
+class RaderKernel {
+    private:
+        size_t p;
+        size_t m; ///< Convolution length: p - 1, or a power of 2 >= 2(p-1) - 1.
+        std::vector<size_t> input_order;  ///< g^q mod p.
+        std::vector<size_t> output_order; ///< g^-q mod p.
+        std::vector<T> filter;            ///< DFT of w^(g^-q) (wrapped to length m), divided by m.
+        std::shared_ptr<const DftKernel<T>> convolution; ///< m-point DFT.
+
+        /**
+        * @brief Returns the largest prime factor of n (n >= 2).
+        */
+        static size_t largest_factor(size_t n) {
+            size_t largest = 1;
+            for (size_t f = 2; f * f <= n; ++f) {
+                while (n % f == 0) {
+                    largest = f;
+                    n /= f;
+                }
+            }
+            return n > 1 ? n : largest;
+        }
+
+        /**
+        * @brief Returns the convolution length of the prime p.
+        */
+        static size_t convolution_length(size_t p) {
+            if (largest_factor(p - 1) <= 13) return p - 1;
+            size_t length = 1;
+            while (length < 2 * (p - 1) - 1) length <<= 1;
+            return length;
+        }
+
+        /**
+        * @brief Returns the smallest primitive root modulo the prime p.
+        */
+        static size_t primitive_root(size_t p) {
+            std::vector<size_t> divisors;
+            size_t rest = p - 1;
+            for (size_t f = 2; f * f <= rest; ++f) {
+                if (rest % f == 0) divisors.push_back(f);
+                while (rest % f == 0) rest /= f;
+            }
+            if (rest > 1) divisors.push_back(rest);
+
+            for (size_t g = 2;; ++g) {
+                bool primitive = true;
+                for (size_t f : divisors) {
+                    if (power_mod(g, (p - 1) / f, p) == 1) {
+                        primitive = false;
+                        break;
+                    }
+                }
+                if (primitive) return g;
+            }
+        }
+
+        /**
+        * @brief Returns base^exponent mod m.
+        */
+        static size_t power_mod(size_t base, size_t exponent, size_t m) {
+            unsigned long long result = 1, b = base % m;
+            while (exponent > 0) {
+                if (exponent & 1) result = result * b % m;
+                b = b * b % m;
+                exponent >>= 1;
+            }
+            return static_cast<size_t>(result);
+        }
+
+    public:
+        /**
+         * @brief Prepares the permutations and the transformed convolution filter.
+         * @param prime The transform length (an odd prime).
+         */
+        explicit RaderKernel(size_t prime)
+            : p(prime), m(convolution_length(prime)), input_order(prime - 1), output_order(prime - 1),
+              filter(m, T(0.0)), convolution(std::make_shared<const DftKernel<T>>(m)) {
+            const size_t g = primitive_root(p);
+            const size_t g_inverse = power_mod(g, p - 2, p);
+            size_t forward = 1, backward = 1;
+            for (size_t q = 0; q + 1 < p; ++q) {
+                input_order[q] = forward;
+                output_order[q] = backward;
+                forward = forward * g % p;
+                backward = backward * g_inverse % p;
+            }
+
+            // b[q] = w^(g^-q); when padded, b[1 .. p-2] also sits at the end so the cyclic
+            // convolution of length m matches the one of length p - 1 on its first p - 1 outputs
+            const double angle = -2.0 * std::acos(-1.0) / static_cast<double>(p);
+            const double scale = 1.0 / static_cast<double>(m);
+            for (size_t q = 0; q + 1 < p; ++q) {
+                const T b = std::polar(scale, angle * static_cast<double>(output_order[q]));
+                filter[q] = b;
+                if (m != p - 1 && q > 0) filter[m - (p - 1) + q] = b;
+            }
+            std::vector<T> scratch(convolution->scratch_size());
+            (*convolution)(filter.data(), scratch.data());
+        }
+
+        /**
+         * @brief Returns the size of the scratch buffer needed by operator().
+         */
+        size_t scratch_size() const {
+            return m + convolution->scratch_size();
+        }
+
+        /**
+         * @brief Overwrites p elements with their forward DFT.
+         * @param data Pointer to p contiguous elements.
+         * @param scratch At least scratch_size() elements, private to the caller.
+         */
+        void operator()(T* data, T* scratch) const {
+            const T x0 = data[0];
+            T sum = x0;
+            for (size_t q = 0; q + 1 < p; ++q) {
+                scratch[q] = data[input_order[q]];
+                sum += scratch[q];
+            }
+            std::fill(scratch + (p - 1), scratch + m, T(0.0));
+
+            // Cyclic convolution: DFT, pointwise product, inverse as conj(DFT(conj(.)))
+            (*convolution)(scratch, scratch + m);
+            for (size_t k = 0; k < m; ++k) scratch[k] = std::conj(scratch[k] * filter[k]);
+            (*convolution)(scratch, scratch + m);
+
+            data[0] = sum;
+            for (size_t u = 0; u + 1 < p; ++u) data[output_order[u]] = x0 + std::conj(scratch[u]);
+        }
+};
+
+/**
+ * @class MixedRadixKernel
+ * @brief Forward DFT of any length by recursive mixed-radix Cooley-Tukey decimation in time.
+ *
+ * n is factored into 4s, 2s, 3s and then the other primes in increasing order. Each
+ * level splits its length r * m into r interleaved sub-transforms of length m, then
+ * combines them with twiddles and r-point butterflies (fixed codelets for 2, 3 and 4,
+ * a direct DFT for primes up to 13 and RaderKernel above), so prime factors inside
+ * composite lengths cost O(p log p) rather than O(p^2).
+ */
+template <typename T>
+class MixedRadixKernel {
+    private:
+        static constexpr size_t RADER_MIN = 17; ///< Smallest prime computed with Rader's algorithm.
+
+        size_t n;
+        std::vector<size_t> factors;
+        std::vector<T> roots;                       ///< exp(-2*pi*i*j/n) for j = 0 .. n-1.
+        std::map<size_t, RaderKernel<T>> raders;    ///< One kernel per large prime factor.
+        size_t radix_max;                           ///< Largest factor.
+        size_t rader_scratch;                       ///< Largest RaderKernel::scratch_size().
+
+        /**
+        * @brief In-place r-point DFT of values (temp: r elements, work: Rader scratch).
+        */
+        void butterfly(T* values, size_t r, T* temp, T* work) const {
+            switch (r) {
+                case 2: {
+                    T a = values[0], b = values[1];
+                    values[0] = a + b;
+                    values[1] = a - b;
+                    return;
+                }
+                case 3: {
+                    // w = exp(-2*pi*i/3): X1,2 = a - (b+c)/2 -+ i*sqrt(3)/2*(b-c)
+                    const double s = 0.86602540378443864676;
+                    T a = values[0], sum = values[1] + values[2], diff = values[1] - values[2];
+                    T mid = a - 0.5 * sum;
+                    T rot(s * diff.imag(), -s * diff.real()); // -i*s*diff
+                    values[0] = a + sum;
+                    values[1] = mid + rot;
+                    values[2] = mid - rot;
+                    return;
+                }
+                case 4: {
+                    T a = values[0], b = values[1], c = values[2], d = values[3];
+                    T s0 = a + c, d0 = a - c, s1 = b + d, d1 = b - d;
+                    T rot(d1.imag(), -d1.real()); // -i*(b-d)
+                    values[0] = s0 + s1;
+                    values[1] = d0 + rot;
+                    values[2] = s0 - s1;
+                    values[3] = d0 - rot;
+                    return;
+                }
+                default:
+                    break;
+            }
+
+            if (r >= RADER_MIN) {
+                raders.at(r)(values, work);
+                return;
+            }
+
+            const size_t step = n / r;
+            for (size_t u = 0; u < r; ++u) {
+                T sum(0.0);
+                for (size_t q = 0; q < r; ++q) sum += values[q] * roots[(u * q % r) * step];
+                temp[u] = sum;
+            }
+            std::copy(temp, temp + r, values);
+        }
+
+        /**
+        * @brief Transforms len elements read with the given stride into out (contiguous).
+        */
+        void recurse(const T* in, size_t stride, T* out, size_t len, size_t level, T* work) const {
+            const size_t r = factors[level];
+            T* values = work;
+            T* temp = work + radix_max;
+            T* rader_work = work + 2 * radix_max;
+
+            if (len == r) {
+                for (size_t j = 0; j < r; ++j) out[j] = in[j * stride];
+                butterfly(out, r, temp, rader_work);
+                return;
+            }
+
+            const size_t m = len / r;
+            for (size_t q = 0; q < r; ++q) {
+                recurse(in + q * stride, stride * r, out + q * m, m, level + 1, work);
+            }
+
+            // X[k + u*m] = sum over q of w_len^(q*k) * Y_q[k] * w_r^(u*q)
+            const size_t step = n / len;
+            for (size_t k = 0; k < m; ++k) {
+                for (size_t q = 0; q < r; ++q) values[q] = out[q * m + k] * roots[q * k * step];
+                butterfly(values, r, temp, rader_work);
+                for (size_t u = 0; u < r; ++u) out[k + u * m] = values[u];
+            }
+        }
+
+    public:
+        /**
+         * @brief Factors the length and prepares the roots and the Rader kernels.
+         * @param length The transform length (at least 2).
+         */
+        explicit MixedRadixKernel(size_t length) : n(length), radix_max(1), rader_scratch(0) {
+            size_t rest = n;
+            while (rest % 4 == 0) { factors.push_back(4); rest /= 4; }
+            while (rest % 2 == 0) { factors.push_back(2); rest /= 2; }
+            for (size_t f = 3; f * f <= rest; f += 2) {
+                while (rest % f == 0) { factors.push_back(f); rest /= f; }
+            }
+            if (rest > 1) factors.push_back(rest);
+
+            roots.resize(n);
+            const double angle = -2.0 * std::acos(-1.0) / static_cast<double>(n);
+            for (size_t j = 0; j < n; ++j) {
+                roots[j] = std::polar(1.0, angle * static_cast<double>(j));
+            }
+
+            for (size_t f : factors) {
+                radix_max = std::max(radix_max, f);
+                if (f >= RADER_MIN && raders.find(f) == raders.end()) {
+                    auto inserted = raders.emplace(f, RaderKernel<T>(f)).first;
+                    rader_scratch = std::max(rader_scratch, inserted->second.scratch_size());
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the size of the scratch buffer needed by operator().
+         */
+        size_t scratch_size() const {
+            return n + 2 * radix_max + rader_scratch;
+        }
+
+        /**
+         * @brief Overwrites n elements with their forward DFT.
+         * @param data Pointer to n contiguous elements.
+         * @param scratch At least scratch_size() elements, private to the caller.
+         */
+        void operator()(T* data, T* scratch) const {
+            std::copy(data, data + n, scratch);
+            recurse(scratch, 1, data, n, 0, scratch + n);
+        }
+};
+
+/**
+ * @class DftKernel
+ * @brief Forward DFT of any fixed length on raw buffers.
+ *
+ * Powers of 2 use fft_in_place(); other lengths use the cached MixedRadixKernel of
+ * their length (Rader's algorithm for large prime factors). All tables are built
+ * once, so the kernel can be applied to many rows (also concurrently, with one
+ * scratch buffer per thread).
+ */
+template <typename T>
+class DftKernel {
+    private:
+        size_t n;
+        std::vector<T> twiddles; ///< make_twiddles(n) (powers of 2 only).
+        std::shared_ptr<const MixedRadixKernel<T>> mixed; ///< Plan of the other lengths.
+
+    public:
+        /**
+         * @brief Prepares the tables of an n-point DFT.
+         * @param length The transform length (at least 1).
+         */
+        explicit DftKernel(size_t length) : n(length) {
+            if ((n & (n - 1)) == 0) {
+                twiddles = make_twiddles<T>(n);
+            } else {
+                mixed = mixed_radix_plan<T>(n);
+            }
+        }
+
+        /**
+         * @brief Returns the size of the scratch buffer needed by operator().
+         */
+        size_t scratch_size() const {
+            return mixed ? mixed->scratch_size() : 0;
+        }
+
+        /**
+         * @brief Overwrites n elements with their forward DFT.
+         * @param data Pointer to n contiguous elements.
+         * @param scratch At least scratch_size() elements, private to the caller.
+         */
+        void operator()(T* data, T* scratch) const {
+            if (mixed) {
+                (*mixed)(data, scratch);
+            } else {
+                fft_in_place(data, n, twiddles, false);
+            }
+        }
+};
+
+/**
+ * @brief Forward DFT of n real samples (n even) through a half-length complex DFT.
+ *
+ * The samples are packed into z[k] = x[2k] + i*x[2k+1] and transformed with the
+ * n/2-point kernel; the n/2 + 1 non-redundant values then follow from
+ *   X[k] = (Z[k] + conj(Z[n/2-k])) / 2 - i/2 * W^k * (Z[k] - conj(Z[n/2-k])).
+ *
+ * @param x The n real samples.
+ * @param n The number of samples (even, at least 2).
+ * @param half_kernel The DftKernel of length n/2.
+ * @param twiddles W^k = exp(-2*pi*i*k/n) for k = 0 .. n/2.
+ * @param z Scratch of n/2 elements.
+ * @param scratch half_kernel.scratch_size() elements.
+ * @param spectrum Receives X[0 .. n/2].
+ */
+template <typename T>
+void real_forward(const double* x, size_t n, const DftKernel<T>& half_kernel, const T* twiddles,
+                  T* z, T* scratch, T* spectrum) {
+    const size_t half = n / 2;
+    for (size_t k = 0; k < half; ++k) z[k] = T(x[2 * k], x[2 * k + 1]);
+    half_kernel(z, scratch);
+
+    for (size_t k = 0; k <= half; ++k) {
+        T zk = z[k % half];
+        T zm = std::conj(z[(half - k) % half]);
+        spectrum[k] = 0.5 * (zk + zm) + T(0.0, -0.5) * twiddles[k] * (zk - zm);
+    }
+}
+
+#endif // KERNELS_HPP
@@ -0,0 +1,251 @@
+/**
+ * @file Mfcc.hpp
+ * @brief Header file for the batched mel-spectrogram / MFCC feature extraction pipeline.
+ */
+#ifndef MFCC_HPP
+#define MFCC_HPP
+
+#include "Kernels.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parameters of the feature extraction.
+ */
+struct MfccConfig {
+    double sample_rate = 44100.0; ///< Samples per second of the audio.
+    size_t frame = 2048;          ///< Samples per frame (even), also the FFT length.
+    size_t hop = 512;             ///< Samples between the starts of consecutive frames.
+    size_t mels = 40;             ///< Number of mel bands.
+    size_t coefficients = 13;     ///< Number of cepstral coefficients kept (at most mels).
+    double fmin = 0.0;            ///< Lowest frequency of the filterbank in Hz.
+    double fmax = 0.0;            ///< Highest frequency of the filterbank in Hz (0 = sample_rate / 2).
+};
+
+/**
+ * @class Mfcc
+ * @brief Log-mel spectrograms and mel-frequency cepstral coefficients of audio, frame by frame.
+ *
+ * Every frame goes through the same fused pipeline, frames being shared among the
+ * OpenMP threads:
+ *   1. Hann window and real FFT of the frame (packed half-length transform);
+ *   2. power spectrum |X[k]|^2 for the frame/2 + 1 bins;
+ *   3. triangular mel filterbank (HTK mel scale) as a sparse matrix: every band stores
+ *      only its contiguous non-zero weights, so the product costs one multiply-add per
+ *      non-zero instead of mels * bins;
+ *   4. natural log of the band energies (floored at 1e-10);
+ *   5. orthonormal DCT-II of the log energies, keeping the first coefficients.
+ * Windows, FFT tables, filterbank and DCT matrix are built once by the constructor.
+ *
+ * @tparam T The complex data type of the FFT (usually std::complex<double>).
+ */
+template <typename T>
+class Mfcc : public TimedTransform {
+    private:
+        MfccConfig config;
+        size_t bins; ///< frame / 2 + 1.
+
+        DftKernel<T> half_kernel;
+        std::vector<T> twiddles;     ///< exp(-2*pi*i*k/frame) for k = 0 .. frame/2.
+        std::vector<double> window;  ///< Periodic Hann window.
+
+        /**
+         * @brief Sparse filterbank: band m has weights[offset[m] .. offset[m+1]) on bins first[m] ...
+         */
+        std::vector<size_t> first, offset;
+        std::vector<double> weights;
+
+        /**
+         * @brief coefficients x mels orthonormal DCT-II matrix, row-major.
+         */
+        std::vector<double> dct;
+
+        static double hz_to_mel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+        static double mel_to_hz(double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); }
+
+        /**
+        * @brief Builds the triangular filters on mels + 2 points equally spaced in mel.
+        */
+        void build_filterbank() {
+            const double top = config.fmax > 0.0 ? config.fmax : config.sample_rate / 2.0;
+            const double low_mel = hz_to_mel(config.fmin);
+            const double high_mel = hz_to_mel(top);
+            const double bin_hz = config.sample_rate / static_cast<double>(config.frame);
+
+            std::vector<double> edges(config.mels + 2);
+            for (size_t i = 0; i < edges.size(); ++i) {
+                edges[i] = mel_to_hz(low_mel + (high_mel - low_mel) * static_cast<double>(i) / static_cast<double>(config.mels + 1));
+            }
+
+            first.resize(config.mels);
+            offset.assign(1, 0);
+            for (size_t m = 0; m < config.mels; ++m) {
+                const double left = edges[m], center = edges[m + 1], right = edges[m + 2];
+                first[m] = bins;
+                for (size_t k = 0; k < bins; ++k) {
+                    const double f = static_cast<double>(k) * bin_hz;
+                    double w = 0.0;
+                    if (f > left && f <= center) {
+                        w = (f - left) / (center - left);
+                    } else if (f > center && f < right) {
+                        w = (right - f) / (right - center);
+                    }
+                    if (w > 0.0) {
+                        if (first[m] == bins) first[m] = k;
+                        // Keep the run contiguous from the first non-zero bin
+                        weights.resize(offset.back() + (k - first[m]) + 1, 0.0);
+                        weights.back() = w;
+                    }
+                }
+                if (first[m] == bins) first[m] = 0; // Band narrower than a bin: empty
+                offset.push_back(weights.size());
+            }
+        }
+
+        /**
+        * @brief Computes the log-mel energies of one frame.
+        */
+        void log_mel(const double* samples, double* mel, double* windowed, T* z, T* scratch, T* spectrum) const {
+            for (size_t i = 0; i < config.frame; ++i) windowed[i] = samples[i] * window[i];
+            real_forward(windowed, config.frame, half_kernel, twiddles.data(), z, scratch, spectrum);
+
+            // The power spectrum reuses the buffer of the windowed samples
+            double* power = windowed;
+            for (size_t k = 0; k < bins; ++k) power[k] = std::norm(spectrum[k]);
+
+            for (size_t m = 0; m < config.mels; ++m) {
+                double energy = 0.0;
+                const double* w = weights.data() + offset[m];
+                const double* p = power + first[m];
+                for (size_t j = 0; j < offset[m + 1] - offset[m]; ++j) energy += w[j] * p[j];
+                mel[m] = std::log(std::max(energy, 1e-10));
+            }
+        }
+
+        /**
+        * @brief Runs the pipeline over every frame, writing width values per frame.
+        * @param cepstrum If true, applies the DCT (width = coefficients), else width = mels.
+        */
+        void run(const double* samples, size_t count, double* features, bool cepstrum) {
+            Timer t;
+            const size_t n_frames = frames(count);
+            const size_t width = cepstrum ? config.coefficients : config.mels;
+
+            #pragma omp parallel
+            {
+                std::vector<double> windowed(std::max(config.frame, bins));
+                std::vector<double> mel(config.mels);
+                std::vector<T> z(config.frame / 2), scratch(half_kernel.scratch_size()), spectrum(bins);
+
+                #pragma omp for schedule(static)
+                for (size_t f = 0; f < n_frames; ++f) {
+                    double* out = features + f * width;
+                    log_mel(samples + f * config.hop, cepstrum ? mel.data() : out,
+                            windowed.data(), z.data(), scratch.data(), spectrum.data());
+                    if (!cepstrum) continue;
+
+                    for (size_t c = 0; c < config.coefficients; ++c) {
+                        const double* row = dct.data() + c * config.mels;
+                        double sum = 0.0;
+                        for (size_t m = 0; m < config.mels; ++m) sum += row[m] * mel[m];
+                        out[c] = sum;
+                    }
+                }
+            }
+
+            this->record_duration(t, n_frames);
+        }
+
+    public:
+        /**
+         * @brief Precomputes window, FFT tables, filterbank and DCT matrix.
+         * @param cfg The parameters of the extraction.
+         * @throws std::invalid_argument If the frame is odd or smaller than 2, the hop is 0,
+         *         there are no mel bands or more coefficients than bands, fmax is above the
+         *         Nyquist frequency, or fmin is negative or not below the highest frequency.
+         */
+        explicit Mfcc(const MfccConfig& cfg)
+            : TimedTransform("Mfcc", false), config(cfg), bins(cfg.frame / 2 + 1),
+              half_kernel(cfg.frame >= 2 ? cfg.frame / 2 : 1) {
+            if (cfg.frame < 2 || cfg.frame % 2 != 0) {
+                throw std::invalid_argument("Frame length must be even and at least 2");
+            }
+            if (cfg.hop == 0 || cfg.mels == 0) {
+                throw std::invalid_argument("Hop and number of mel bands must be positive");
+            }
+            if (cfg.coefficients > cfg.mels) {
+                throw std::invalid_argument("Cannot keep more coefficients than mel bands");
+            }
+            if (cfg.fmax > cfg.sample_rate / 2.0) {
+                throw std::invalid_argument("Highest frequency must not exceed the Nyquist frequency");
+            }
+            const double top = cfg.fmax > 0.0 ? cfg.fmax : cfg.sample_rate / 2.0;
+            if (cfg.fmin < 0.0 || cfg.fmin >= top) {
+                throw std::invalid_argument("Lowest frequency must be non-negative and below the highest");
+            }
+
+            const double pi = std::acos(-1.0);
+            twiddles.resize(bins);
+            window.resize(config.frame);
+            for (size_t k = 0; k < bins; ++k) {
+                twiddles[k] = std::polar(1.0, -2.0 * pi * static_cast<double>(k) / static_cast<double>(config.frame));
+            }
+            for (size_t i = 0; i < config.frame; ++i) {
+                window[i] = 0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / static_cast<double>(config.frame));
+            }
+
+            build_filterbank();
+
+            dct.resize(config.coefficients * config.mels);
+            for (size_t c = 0; c < config.coefficients; ++c) {
+                const double scale = std::sqrt((c == 0 ? 1.0 : 2.0) / static_cast<double>(config.mels));
+                for (size_t m = 0; m < config.mels; ++m) {
+                    dct[c * config.mels + m] = scale * std::cos(pi * static_cast<double>(c) * (2.0 * static_cast<double>(m) + 1.0) / (2.0 * static_cast<double>(config.mels)));
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the number of complete frames in count samples.
+         */
+        size_t frames(size_t count) const {
+            return count < config.frame ? 0 : 1 + (count - config.frame) / config.hop;
+        }
+
+        /**
+         * @brief Computes the MFCCs of every complete frame.
+         * @param samples The audio samples.
+         * @param count The number of samples.
+         * @param features Receives frames(count) x coefficients values, row-major.
+         */
+        void compute(const double* samples, size_t count, double* features) {
+            run(samples, count, features, true);
+        }
+
+        /**
+         * @brief Computes the log-mel spectrogram of every complete frame.
+         * @param samples The audio samples.
+         * @param count The number of samples.
+         * @param features Receives frames(count) x mels values, row-major.
+         */
+        void melSpectrogram(const double* samples, size_t count, double* features) {
+            run(samples, count, features, false);
+        }
+
+        /**
+         * @brief Returns the number of non-zero weights of the filterbank.
+         */
+        size_t filterbankSize() const {
+            return weights.size();
+        }
+};
+
+#endif // MFCC_HPP
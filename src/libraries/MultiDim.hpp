@@ -0,0 +1,188 @@
+/**
+ * @file MultiDim.hpp
+ * @brief Header file for multidimensional real-input transforms (r2c / c2r).
+ */
+#ifndef MULTIDIM_HPP
+#define MULTIDIM_HPP
+
+#include "Kernels.hpp"
+#include "Strided.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class RealMultiDim
+ * @brief d-dimensional DFT of real data (images, physical fields) stored row-major.
+ *
+ * The forward transform (r2c) maps dims[0] x ... x dims[d-1] real samples to the
+ * dims[0] x ... x (dims[d-1]/2 + 1) non-redundant complex coefficients, the rest
+ * following from Hermitian symmetry. Along the last axis every row of n real samples
+ * is packed into n/2 complex values z[k] = x[2k] + i*x[2k+1] and transformed with a
+ * half-length FFT; the other axes are complex transforms on the halved array, so
+ * compute and memory are about half of a complex transform of the same shape.
+ * Row passes are shared among the OpenMP threads, the other axes run through
+ * StridedPlan (blocked copies of neighbouring columns).
+ *
+ * @tparam T The complex data type (usually std::complex<double>).
+ */
+template <typename T>
+class RealMultiDim : public TimedTransform {
+    private:
+        std::vector<size_t> dims;
+
+        /**
+         * @brief Number of real rows (product of all dims but the last).
+         */
+        size_t rows;
+
+        /**
+         * @brief Real row length n and complex row length n/2 + 1.
+         */
+        size_t n, h;
+
+        /**
+         * @brief Half-length DFT of the packed rows.
+         */
+        DftKernel<T> half_kernel;
+
+        /**
+         * @brief exp(-2*pi*i*k/n) for k = 0 .. n/2 (post-processing of the packed rows).
+         */
+        std::vector<T> twiddles;
+
+        /**
+        * @brief Runs a complex transform along every axis but the last on the halved array.
+        *
+        * Axis a is a batch of strided transforms for each combination of the outer indices:
+        * length dims[a], stride and howmany equal to the product of the following axes.
+        */
+        void complex_axes(T* data, bool inverse) const {
+            const size_t d = dims.size();
+            size_t inner = h;
+            for (size_t a = d - 1; a-- > 0;) {
+                const size_t length = dims[a];
+                size_t outer = 1;
+                for (size_t b = 0; b < a; ++b) outer *= dims[b];
+
+                StridedPlan<T> plan(length, {inner, static_cast<ptrdiff_t>(inner), 1},
+                                            {inner, static_cast<ptrdiff_t>(inner), 1});
+                for (size_t o = 0; o < outer; ++o) {
+                    T* base = data + o * length * inner;
+                    if (inverse) {
+                        plan.reverseCompute(base, base);
+                    } else {
+                        plan.compute(base, base);
+                    }
+                }
+                inner *= length;
+            }
+        }
+
+    public:
+        /**
+         * @brief Prepares transforms of the given shape.
+         * @param shape The sizes of the d axes, row-major (the last one must be even).
+         * @throws std::invalid_argument If the shape is empty, has a 0 axis or an odd last axis.
+         */
+        explicit RealMultiDim(const std::vector<size_t>& shape)
+            : TimedTransform("RealMultiDim", true), dims(shape), rows(1),
+              n(shape.empty() ? 2 : shape.back()), h(n / 2 + 1), half_kernel(n >= 2 ? n / 2 : 1) {
+            if (shape.empty() || n < 2 || n % 2 != 0) {
+                throw std::invalid_argument("The last axis must be even and at least 2");
+            }
+            for (size_t a = 0; a + 1 < dims.size(); ++a) {
+                if (dims[a] == 0) throw std::invalid_argument("Axes must not be empty");
+                rows *= dims[a];
+            }
+
+            twiddles.resize(h);
+            double angle = -2.0 * std::acos(-1.0) / static_cast<double>(n);
+            for (size_t k = 0; k < h; ++k) {
+                twiddles[k] = std::polar(1.0, angle * static_cast<double>(k));
+            }
+        }
+
+        /**
+         * @brief Returns the number of complex coefficients produced by compute().
+         */
+        size_t complex_size() const {
+            return rows * h;
+        }
+
+        /**
+         * @brief Forward r2c transform.
+         * @param in rows * dims.back() real samples.
+         * @param out Receives complex_size() coefficients, shape dims[0] x ... x (dims.back()/2 + 1).
+         */
+        void compute(const double* in, T* out) {
+            Timer t;
+            const size_t half = n / 2;
+
+            // Real rows: packed half-length FFT, then the Hermitian split
+            #pragma omp parallel
+            {
+                std::vector<T> z(half);
+                std::vector<T> scratch(half_kernel.scratch_size());
+
+                #pragma omp for schedule(static)
+                for (size_t r = 0; r < rows; ++r) {
+                    real_forward(in + r * n, n, half_kernel, twiddles.data(), z.data(), scratch.data(), out + r * h);
+                }
+            }
+
+            complex_axes(out, false);
+
+            this->record_duration(t, rows * n);
+        }
+
+        /**
+         * @brief Inverse c2r transform (normalized), the input being the output of compute().
+         * @param in complex_size() Hermitian coefficients (not modified).
+         * @param out Receives rows * dims.back() real samples.
+         */
+        void reverseCompute(const T* in, double* out) {
+            Timer t;
+            const size_t half = n / 2;
+
+            std::vector<T> spectrum(in, in + complex_size());
+            complex_axes(spectrum.data(), true);
+
+            // Fold every row into the spectrum of z[k] = x[2k] + i*x[2k+1]
+            #pragma omp parallel
+            {
+                std::vector<T> z(half);
+                std::vector<T> scratch(half_kernel.scratch_size());
+
+                #pragma omp for schedule(static)
+                for (size_t r = 0; r < rows; ++r) {
+                    const T* row = spectrum.data() + r * h;
+                    for (size_t k = 0; k < half; ++k) {
+                        T upper = std::conj(row[half - k]); // X[k + n/2]
+                        T even = 0.5 * (row[k] + upper);
+                        T odd = 0.5 * (row[k] - upper) * std::conj(twiddles[k]);
+                        // Conjugated so that the forward kernel computes the inverse
+                        z[k] = std::conj(even + T(0.0, 1.0) * odd);
+                    }
+                    half_kernel(z.data(), scratch.data());
+
+                    double* x = out + r * n;
+                    for (size_t k = 0; k < half; ++k) {
+                        T value = std::conj(z[k]) / static_cast<double>(half);
+                        x[2 * k] = value.real();
+                        x[2 * k + 1] = value.imag();
+                    }
+                }
+            }
+
+            this->record_duration(t, rows * n, true);
+        }
+};
+
+#endif // MULTIDIM_HPP
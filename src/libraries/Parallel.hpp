@@ -1,262 +1,1176 @@
-/**
- * @file Parallel.hpp
- * @brief Header file for the Parallel FFT implementation.
- */
-#ifndef PARALLEL_HPP
-#define PARALLEL_HPP
-
-#include "Fourier.hpp"
-#include "../utilities/Timer.hpp"
-#include <mpi.h>
-#include <cmath>
-#include <vector>
-#include <complex>
-#include <algorithm>
-
-/**
- * @class Parallel
- * @brief Implements the Fast Fourier Transform using MPI for distributed computing
- * and OpenMP for local parallelism.
- * @tparam T The data type of the signal.
- */
-template <typename T>
-class Parallel : public Fourier<T> {
-    private:
-        // MPI variables
-        int rank;
-        int size;
-        MPI_Comm comm;
-
-        /**
-        * @brief Performs one stage of the Cooley-Tukey butterfly operations.
-        * @param data The vector to modify (can be local_data or full_data).
-        * @param local_n The number of elements to process in this vector.
-        * @param len The length of the current stage.
-        * @param inverse Whether to perform the inverse FFT stage.
-        */
-        void butterfly_stage(std::vector<T>& data, size_t local_n, size_t len, bool inverse) {
-            // If inverse is true (inverse FFT), angle is positive. If false, angle is negative.
-            double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
-            std::complex<double> wlen(std::cos(angle), std::sin(angle));
-
-            // Heuristic: if the number of outer iterations is large enough, use the efficient recurrence.
-            // Otherwise (large len), use collapse(2) with direct calculation to maximize parallelism.
-            if (local_n / len >= 32) {
-                #pragma omp parallel for schedule(static)
-                for (size_t i = 0; i < local_n; i += len) {
-                    std::complex<double> w(1.0, 0.0);
-                    for (size_t j = 0; j < len / 2; j++) {
-                        std::complex<double> u = data[i + j];
-                        std::complex<double> v = data[i + j + len / 2] * w;
-
-                        // butterfly operation
-                        data[i + j] = u + v;
-                        data[i + j + len / 2] = u - v;
-
-                        // update w
-                        w *= wlen;
-                    }
-                }
-            } else {
-                #pragma omp parallel for collapse(2) schedule(static)
-                for (size_t i = 0; i < local_n; i += len) {
-                    for (size_t j = 0; j < len / 2; j++) {
-                        std::complex<double> w = std::polar(1.0, angle * j);
-                        std::complex<double> u = data[i + j];
-                        std::complex<double> v = data[i + j + len / 2] * w;
-
-                        // butterfly operation
-                        data[i + j] = u + v;
-                        data[i + j + len / 2] = u - v;
-                    }
-                }
-            }
-        }
-
-        /**
-        * @brief The method that runs both Forward and Inverse Fast Fourier Transform using MPI and OpenMP.
-        * 
-        * This method performs the FFT in parallel. It handles data distribution,
-        * bit-reversal permutation (on rank 0), and butterfly operations.
-        * For stages where the butterfly width exceeds local data size, data is gathered
-        * to rank 0, processed, and scattered back.
-        *
-        * @note This implementation gathers data to Rank 0 for stages where the butterfly width exceeds the local partition size.
-        *
-        * @param inverse If true, uses positive angles and normalizes the result.
-        */
-        void executeFFT(bool inverse) {
-            // Implementation of parallel FFT computation
-            Timer t;
-
-            // Setup
-            int global_n = 0;
-            if (rank == 0) {
-                global_n = static_cast<int>(this->input->size());
-            }
-            // Broadcast total size to all processes
-            MPI_Bcast(&global_n, 1, MPI_INT, 0, comm);
-
-            // Compute log_n
-            size_t log_n = 0;
-            while ((size_t(1) << log_n) < static_cast<size_t>(global_n)) log_n++; // casting global_n to size_t
-
-            // Bit reversal permutation
-            std::vector<T> permuted_input;
-            // rank 0 only (because just the root process handles the initial data permutation)
-            if (rank == 0) {
-                permuted_input.resize(global_n);
-
-                // "schedule(static)" because the work per iteration is identical
-                #pragma omp parallel for schedule(static)
-                for (size_t i = 0; i < static_cast<size_t>(global_n); ++i) { // casting gloabl_n to use size_t
-                    size_t j = 0; // variable to save the reversed index
-                    size_t temp_i = i;
-
-                    // Bit reversal computation from the indices i to j
-                    for (size_t bit = 0; bit < log_n; ++bit) {
-                        j = (j << 1) | (temp_i & 1);
-                        temp_i >>= 1;
-                    }
-                    
-                    // Note that no two threads write to same 'j' (so it's safe)
-                    permuted_input[j] = (*(this->input))[i];
-                }
-
-                // Prepare Output: resize output on rank 0 to hold final result later
-                if (this->output == nullptr) {
-                    this->output = make_unique<vector<T>>(global_n);
-                } else {
-                    this->output->resize(global_n);
-                }
-            }
-
-            // Scatter permuted input to all processes:
-            int local_n = global_n / size;// Local partition size (Note: MPI counts must be int)
-            std::vector<T> local_data(local_n);// Each process gets a chunk of size local_n
-
-            // Mapping T from std::complex<double> to MPI_C_DOUBLE_COMPLEX
-            MPI_Scatter(rank == 0 ? permuted_input.data() : nullptr, 
-                        local_n, MPI_C_DOUBLE_COMPLEX,
-                        local_data.data(), 
-                        local_n, MPI_C_DOUBLE_COMPLEX, 
-                        0, comm);
-
-            // Butterfly operations Stages
-            // The outer loop goes throw the "Stage" of the FFT (cannot be parallelized due to dependencies)
-            for (int len = 2; len <= global_n; len <<= 1) {
-                
-                // CASE 1: The butterfly fits entirely inside local memory
-                if (len <= local_n) {
-                    butterfly_stage(local_data, local_n, len, inverse); // casting: local_n is int and len is size_t
-                    // Pass the inverse flag to handle both FFT and IFFT
-                }
-
-                // CASE 2: The butterfly spans multiple processes, distributed calculation
-                else {                    
-                    size_t half_len = len / 2;
-                    // Calculate how many processes are in one "half" of the butterfly
-                    // Since len > local_n, the butterfly stride spans across processes.
-                    int group_size = static_cast<int>(half_len / local_n); 
-                    
-                    // Find partner process using XOR (hypercube topology)
-                    int partner = rank ^ group_size;
-
-                    std::vector<T> buffer(local_n);
-
-                    // Exchange data with partner
-                    MPI_Status status;
-                    MPI_Sendrecv(local_data.data(), local_n, MPI_C_DOUBLE_COMPLEX, partner, 0,
-                                 buffer.data(), local_n, MPI_C_DOUBLE_COMPLEX, partner, 0,
-                                 comm, &status);
-
-                    // Determine if I am the "lower" (u) or "upper" (v) part of the butterfly
-                    // If the bit corresponding to group_size is 0, I am lower.
-                    bool is_lower = (rank & group_size) == 0;
-
-                    // Calculate angle parameters
-                    double angle = (inverse ? 2.0 : -2.0) * std::acos(-1.0) / len;
-                    
-                    // Calculate the global index offset for w calculation
-                    // The 'j' index in the butterfly runs 0..half_len-1
-                    // My segment of 'j' starts at (rank % group_size) * local_n
-                    size_t start_j = (rank % group_size) * local_n;
-
-                    #pragma omp parallel for schedule(static)
-                    for (size_t i = 0; i < static_cast<size_t>(local_n); ++i) {
-                        // Calculate w for this specific index
-                        std::complex<double> w = std::polar(1.0, angle * static_cast<double>(start_j + i));
-                        
-                        std::complex<double> u, v;
-                        if (is_lower) {
-                            // I have u, received v
-                            u = local_data[i];
-                            v = buffer[i];
-                            local_data[i] = u + v * w;
-                        } else {
-                            // I have v, received u
-                            u = buffer[i];
-                            v = local_data[i];
-                            local_data[i] = u - v * w;
-                        }
-                    }
-                }
-            }
-
-            //Final Gather
-            MPI_Gather(local_data.data(), local_n, MPI_C_DOUBLE_COMPLEX,
-                    rank == 0 ? this->output->data() : nullptr, local_n, MPI_C_DOUBLE_COMPLEX, 0, comm);
-
-            // Normalization (is needed for the inverse only!)
-            if (inverse && rank == 0) {
-                #pragma omp parallel for
-                for (size_t i = 0; i < static_cast<size_t>(global_n); ++i) {
-                    (*(this->output))[i] /= static_cast<double>(global_n);
-                }
-            }
-
-            this->duration = t.stop_and_return();
-        }
-    
-
-    public:
-        /**
-         * @brief Constructs a Parallel FFT object.
-         * 
-         * Initializes MPI rank and size based on the provided communicator.
-         * 
-         * @param communicator The MPI communicator to use (default: MPI_COMM_WORLD).
-         */
-        Parallel(MPI_Comm communicator = MPI_COMM_WORLD) : comm(communicator) {
-            MPI_Comm_rank(comm, &rank);
-            MPI_Comm_size(comm, &size);
-        }
-        
-        /**
-         * @brief Computes the forward Fast Fourier Transform using MPI and OpenMP.
-         */
-        void compute() override{
-            // Forward FFT computation
-            executeFFT(false); // inverse = false
-        }
-
-        /**
-         * @brief Computes the inverse Fast Fourier Transform using MPI and OpenMP.
-         */
-        void reverseCompute() override {
-            // Inverse FFT computation
-            executeFFT(true); // inverse = true
-        }
-
-        /**
-         * @brief Prints the statistics of the Parallel FFT/IFFT execution.
-         * @param label "FFT" or "IFFT"
-         */
-        void printStats(const std::string& label) override {
-            if (rank == 0) {
-                std::cout << "Parallel " << label << " Duration: " << this->duration << " ms" << std::endl;
-            }
-        }
-};
-
+/**
+ * @file Parallel.hpp
+ * @brief Header file for the Parallel FFT implementation.
+ */
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include "Fourier.hpp"
+#include "Communicator.hpp"
+#include "Compression.hpp"
+#include "Kernels.hpp"
+#include "../utilities/Timer.hpp"
+#include <mpi.h>
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief How partner ranks exchange their blocks in the cross-rank butterfly stages.
+ */
+enum class ExchangeMode {
+    SendRecv, ///< Two-sided MPI_Sendrecv into a temporary buffer.
+    RMA       ///< One-sided MPI_Get from the partner's window, synchronized with MPI_Win_fence.
+};
+
+/**
+ * @class Parallel
+ * @brief Implements the Fast Fourier Transform using MPI for distributed computing
+ * and OpenMP for local parallelism.
+ *
+ * Setup broadcast, scatter, gather and the two-sided exchanges go through a
+ * Communicator, so the same algorithm also runs on threads (see Distributed).
+ * The RMA exchange, the pipelined scatter/gather and persistent plans use MPI
+ * directly and need an engine built on an MPI communicator.
+ *
+ * @tparam T The data type of the signal.
+ */
+template <typename T>
+class Parallel : public Fourier<T> {
+    private:
+        // MPI variables
+        int rank;
+        int size;
+        MPI_Comm comm;
+
+        /**
+         * @brief Collectives of the unplanned transforms (wraps comm, unless built on another Communicator).
+         */
+        std::unique_ptr<Communicator<T>> channel;
+
+        /**
+         * @brief Communication scheme of the cross-rank stages.
+         */
+        ExchangeMode exchange = ExchangeMode::SendRecv;
+
+        /**
+         * @brief Number of chunks each local block is streamed in during scatter and gather (1 = no pipelining).
+         */
+        int pipeline_chunks = 1;
+
+        /**
+         * @brief Block length of the task dataflow of the local stages (0 = one parallel loop per stage).
+         */
+        size_t dataflow_block = DATAFLOW_BLOCK;
+
+        /**
+         * @brief First message tag of the pipelined scatter/gather chunks (below are the exchange tags).
+         */
+        static constexpr int CHUNK_TAG = 16;
+
+        /**
+         * @brief Format of the values in scatter, gather and two-sided exchanges.
+         */
+        WireFormat wire_format = WireFormat::Double;
+
+        /**
+         * @brief Encoding buffers of the compressed transfers.
+         */
+        std::vector<unsigned char> send_wire, recv_wire;
+
+        /**
+         * @brief Bytes sent to other ranks by this rank since the last finished transform.
+         */
+        long long local_traffic = 0;
+
+        /**
+         * @brief Bytes sent between all ranks by the last transform (valid on rank 0).
+         */
+        long long traffic = 0;
+
+        /**
+         * @struct Plan
+         * @brief Everything a transform of a fixed size needs, set up once by plan().
+         */
+        struct Plan {
+            int global_n = 0;              ///< Planned transform length (0 = no plan).
+            int local_n = 0;               ///< Local block length.
+            MPI_Comm comm = MPI_COMM_NULL; ///< Private duplicate of the engine communicator.
+            std::vector<size_t> reversed;  ///< Scatter position of every input element (rank 0 only).
+            std::vector<T> permuted_input; ///< Permutation buffer (rank 0 only).
+            std::vector<T> local_data;     ///< Local block.
+            std::vector<T> buffer;         ///< Partner block of the cross-rank stages.
+            std::vector<T> local_twiddles; ///< exp(-2*pi*i*j/local_n) for the local stages.
+            std::vector<std::vector<T>> stage_twiddles; ///< Per-element twiddles of every cross-rank stage.
+            std::vector<int> partners;     ///< Partner rank of every cross-rank stage.
+            std::vector<MPI_Request> requests; ///< Persistent send/recv pair of every cross-rank stage (SendRecv mode).
+            MPI_Win win = MPI_WIN_NULL;    ///< Window over local_data (RMA mode).
+        };
+
+        /**
+         * @brief The persistent plan, if any.
+         */
+        Plan plan_state;
+
+        /**
+         * @brief Single-node engine computing the local sub-transforms (nullptr = built-in butterfly stages).
+         */
+        std::unique_ptr<Fourier<T>> local_engine;
+
+        /**
+        * @brief Exchanges n values with a partner, encoded in the configured wire format.
+        * @param send The values to send.
+        * @param recv Receives the partner's values.
+        * @param n The number of values.
+        * @param partner The partner rank.
+        */
+        void sendrecv_values(const T* send, T* recv, int n, int partner) {
+            // In long long: n values of up to 16 bytes overflow an int from n = 2^27 on
+            const long long bytes = static_cast<long long>(n) * wire_bytes_per_value(wire_format);
+            if (partner != rank) local_traffic += bytes;
+
+            if (wire_format == WireFormat::Double) {
+                channel->sendrecv(send, recv, n, partner);
+                return;
+            }
+
+            pack_wire(send, n, wire_format, send_wire);
+            recv_wire.resize(static_cast<size_t>(bytes));
+            channel->sendrecv_values(send_wire.data(), recv_wire.data(), n, wire_bytes_per_value(wire_format), partner);
+            unpack_wire(recv_wire.data(), n, wire_format, recv);
+        }
+
+        /**
+        * @brief Scatters local_n values to every rank from rank 0, in the configured wire format.
+        *
+        * Rank 0 keeps its own block exact.
+        *
+        * @param send The size * local_n values to distribute (rank 0 only).
+        * @param recv Receives the local block.
+        * @param local_n The local block length.
+        */
+        void scatter_blocks(const T* send, T* recv, int local_n) {
+            const long long bytes = static_cast<long long>(local_n) * wire_bytes_per_value(wire_format);
+            if (rank == 0) local_traffic += (size - 1) * bytes;
+
+            if (wire_format == WireFormat::Double) {
+                channel->scatter(send, recv, local_n, 0);
+                return;
+            }
+
+            if (rank == 0) pack_wire(send, static_cast<size_t>(local_n) * size, wire_format, send_wire);
+            recv_wire.resize(static_cast<size_t>(bytes));
+            channel->scatter_values(send_wire.data(), recv_wire.data(), local_n, wire_bytes_per_value(wire_format), 0);
+            if (rank == 0) {
+                std::copy(send, send + local_n, recv);
+            } else {
+                unpack_wire(recv_wire.data(), local_n, wire_format, recv);
+            }
+        }
+
+        /**
+        * @brief Gathers local_n values from every rank on rank 0, in the configured wire format.
+        *
+        * Rank 0's own block is copied exactly.
+        *
+        * @param send The local block.
+        * @param recv Receives the size * local_n values (rank 0 only).
+        * @param local_n The local block length.
+        */
+        void gather_blocks(const T* send, T* recv, int local_n) {
+            const long long bytes = static_cast<long long>(local_n) * wire_bytes_per_value(wire_format);
+            if (rank != 0) local_traffic += bytes;
+
+            if (wire_format == WireFormat::Double) {
+                channel->gather(send, recv, local_n, 0);
+                return;
+            }
+
+            pack_wire(send, local_n, wire_format, send_wire);
+            if (rank == 0) recv_wire.resize(static_cast<size_t>(bytes) * size);
+            channel->gather_values(send_wire.data(), recv_wire.data(), local_n, wire_bytes_per_value(wire_format), 0);
+            if (rank == 0) {
+                std::copy(send, send + local_n, recv);
+                unpack_wire(recv_wire.data() + bytes, static_cast<size_t>(local_n) * (size - 1), wire_format, recv + local_n);
+            }
+        }
+
+        /**
+        * @brief Stops the timer and sums the bytes every rank sent during the transform on rank 0.
+        * @param t The timer started at the beginning of the transform.
+        * @param n The transform length.
+        * @param inverse True for an inverse transform.
+        */
+        void finish(Timer& t, size_t n, bool inverse) {
+            this->record_duration(t, n, inverse);
+            channel->reduce_sum(local_traffic, 0);
+            if (rank == 0) traffic = local_traffic;
+            local_traffic = 0;
+        }
+
+        /**
+        * @brief Fetches the partner's block for a cross-rank stage.
+        *
+        * With ExchangeMode::SendRecv both partners rendezvous in MPI_Sendrecv (in the
+        * configured wire format). With
+        * ExchangeMode::RMA every rank reads the partner's block from the window with
+        * MPI_Get; the first fence guarantees the partner finished the previous stage,
+        * the second one that the get completed on both sides before local_data is updated.
+        *
+        * @param local_data The local block (exposed by win in RMA mode).
+        * @param buffer Receives the partner's block.
+        * @param local_n The block length.
+        * @param partner The partner rank.
+        * @param win The window over local_data (RMA mode only).
+        * @param first_epoch True for the first RMA epoch on win.
+        */
+        void exchange_block(std::vector<T>& local_data, std::vector<T>& buffer, int local_n,
+                            int partner, MPI_Win win, bool first_epoch) {
+            if (exchange == ExchangeMode::RMA) {
+                MPI_Win_fence(MPI_MODE_NOPUT | (first_epoch ? MPI_MODE_NOPRECEDE : 0), win);
+                MPI_Get(buffer.data(), local_n, MPI_C_DOUBLE_COMPLEX,
+                        partner, 0, local_n, MPI_C_DOUBLE_COMPLEX, win);
+                MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOSUCCEED, win);
+                local_traffic += static_cast<long long>(local_n) * sizeof(T);
+            } else {
+                // Exchange data with partner
+                sendrecv_values(local_data.data(), buffer.data(), local_n, partner);
+            }
+        }
+
+        /**
+        * @brief Returns the index obtained by reversing the lowest log_n bits of i.
+        * @param i The index to reverse.
+        * @param log_n The number of significant bits.
+        * @return size_t The bit-reversed index.
+        */
+        static size_t reverse_bits(size_t i, size_t log_n) {
+            size_t j = 0; // variable to save the reversed index
+            // Bit reversal computation from the indices i to j
+            for (size_t bit = 0; bit < log_n; ++bit) {
+                j = (j << 1) | (i & 1);
+                i >>= 1;
+            }
+            return j;
+        }
+
+        /**
+        * @brief Returns where rank 0 places input element k before the scatter.
+        *
+        * With the built-in kernels the input is bit-reversed, so block r holds the
+        * subsequence x[m*size + rev(r)] in bit-reversed order and the local stages
+        * (len <= local_n) compute its DFT in place. A local engine expects natural
+        * order, so the same subsequence is stored in natural order instead:
+        * element k = m*size + s goes to position m of block rev(s).
+        *
+        * @param k The index of the element in the input.
+        * @param log_n The number of bits of the global index.
+        * @param local_n The local block length.
+        * @return size_t The position of element k in the scattered array.
+        */
+        size_t scatter_position(size_t k, size_t log_n, size_t local_n) const {
+            if (!local_engine) return reverse_bits(k, log_n);
+
+            size_t log_size = 0;
+            while ((size_t(1) << log_size) < static_cast<size_t>(size)) log_size++;
+            return reverse_bits(k & (size - 1), log_size) * local_n + (k >> log_size);
+        }
+
+        /**
+        * @brief Runs the butterfly stages first_len .. n on a bit-reversed local block or chunk.
+        *
+        * Uses the task dataflow of dataflow_stages(), or one butterfly_stage() parallel loop
+        * per stage if the dataflow block length is 0.
+        *
+        * @param data Pointer to the n elements.
+        * @param n The number of elements.
+        * @param inverse Whether to perform the inverse FFT stages.
+        * @param first_len The length of the first stage to run.
+        */
+        void local_stages(T* data, size_t n, bool inverse, size_t first_len = 2) {
+            if (dataflow_block > 0) {
+                dataflow_stages(data, n, inverse, first_len, static_cast<const T*>(nullptr), dataflow_block);
+                return;
+            }
+            for (size_t len = first_len; len <= n; len <<= 1) {
+                butterfly_stage(data, n, len, inverse);
+            }
+        }
+
+        /**
+        * @brief Computes the local sub-transform: every stage with len <= local_n.
+        *
+        * Runs the local engine on the block if one is set (the inverse is obtained as
+        * conj(FFT(conj(x))), so the engine's own normalization does not interfere),
+        * otherwise the built-in butterfly stages on the bit-reversed block.
+        *
+        * @param local_data The local block, laid out as produced by scatter_position().
+        * @param inverse Whether to perform the inverse FFT stages.
+        */
+        void local_transform(std::vector<T>& local_data, bool inverse) {
+            const size_t local_n = local_data.size();
+
+            if (!local_engine) {
+                local_stages(local_data.data(), local_n, inverse);
+                return;
+            }
+
+            if (inverse) {
+                #pragma omp parallel for schedule(static)
+                for (size_t i = 0; i < local_n; ++i) local_data[i] = std::conj(local_data[i]);
+            }
+
+            // Copied, not moved: persistent requests and windows point into local_data
+            local_engine->setInput(local_data);
+            local_engine->compute();
+            const std::vector<T>& result = local_engine->getOutput();
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < local_n; ++i) {
+                local_data[i] = inverse ? std::conj(result[i]) : result[i];
+            }
+        }
+
+        /**
+        * @brief Runs all butterfly stages on the distributed, bit-reversed data.
+        *
+        * Stages whose butterfly fits inside local_n are computed locally, the others
+        * exchange the whole local block with the partner rank (hypercube topology)
+        * using the configured ExchangeMode.
+        * On return, rank r holds the outputs r*local_n ... (r+1)*local_n - 1 in natural order.
+        *
+        * @param local_data The local block of this rank.
+        * @param global_n The total transform length.
+        * @param local_n The local block length (global_n / size).
+        * @param inverse Whether to perform the inverse FFT stages.
+        * @param first_len The length of the first stage still to run (smaller stages were already applied,
+        *                  e.g. 2 * local_n after local_transform()).
+        * @param on_final_chunk If set, the last (cross-rank) stage is computed in pipeline_chunks chunks
+        *                       and called with (offset, count) as soon as each chunk is final.
+        */
+        void distributed_stages(std::vector<T>& local_data, int global_n, int local_n, bool inverse,
+                                int first_len = 2,
+                                const std::function<void(size_t, size_t)>& on_final_chunk = nullptr) {
+            // In RMA mode each rank exposes its block once for all the cross-rank stages
+            MPI_Win win = MPI_WIN_NULL;
+            bool first_epoch = true;
+            if (exchange == ExchangeMode::RMA && global_n > local_n) {
+                MPI_Win_create(local_data.data(), static_cast<MPI_Aint>(local_n * sizeof(T)), sizeof(T),
+                               MPI_INFO_NULL, comm, &win);
+            }
+            std::vector<T> buffer;
+
+            // CASE 1: The butterflies fit entirely inside local memory (all these stages at once)
+            if (first_len <= local_n) {
+                local_stages(local_data.data(), local_n, inverse, first_len); // Handles both FFT and IFFT
+            }
+
+            // Butterfly operations Stages
+            // The outer loop goes throw the "Stage" of the FFT (cannot be parallelized due to dependencies)
+            for (int len = std::max(first_len, 2 * local_n); len <= global_n; len <<= 1) {
+                // CASE 2: The butterfly spans multiple processes, distributed calculation
+                size_t half_len = len / 2;
+                // Calculate how many processes are in one "half" of the butterfly
+                // Since len > local_n, the butterfly stride spans across processes.
+                int group_size = static_cast<int>(half_len / local_n); 
+                
+                // Find partner process using XOR (hypercube topology)
+                int partner = rank ^ group_size;
+
+                buffer.resize(local_n);
+                exchange_block(local_data, buffer, local_n, partner, win, first_epoch);
+                first_epoch = false;
+
+                // Determine if I am the "lower" (u) or "upper" (v) part of the butterfly
+                // If the bit corresponding to group_size is 0, I am lower.
+                bool is_lower = (rank & group_size) == 0;
+                
+                // Calculate the global index offset for w calculation
+                // The 'j' index in the butterfly runs 0..half_len-1
+                // My segment of 'j' starts at (rank % group_size) * local_n
+                size_t start_j = (rank % group_size) * local_n;
+
+                // The last stage can hand finished chunks to the gather while the rest is computed
+                bool stream = (len == global_n) && on_final_chunk;
+                size_t chunk_n = stream ? local_n / pipeline_chunks : local_n;
+
+                for (size_t begin = 0; begin < static_cast<size_t>(local_n); begin += chunk_n) {
+                    cross_rank_butterfly(local_data.data() + begin, buffer.data() + begin, chunk_n,
+                                         start_j + begin, len, is_lower, inverse);
+
+                    if (stream) on_final_chunk(begin, chunk_n);
+                }
+            }
+
+            if (win != MPI_WIN_NULL) {
+                MPI_Win_free(&win);
+            }
+        }
+
+        /**
+        * @brief Returns the chunk length of the pipelined scatter/gather, or 0 if it is not used.
+        *
+        * Pipelining needs an MPI communicator, more than one rank, local blocks that split evenly
+        * into pipeline_chunks and the built-in local kernels (a local engine needs the whole block at once).
+        */
+        int pipeline_chunk_length(int local_n) const {
+            if (pipeline_chunks <= 1 || size == 1 || local_n % pipeline_chunks != 0 || local_engine) return 0;
+            if (comm == MPI_COMM_NULL) return 0;
+            return local_n / pipeline_chunks;
+        }
+
+        /**
+        * @brief Scatters the bit-reversed input in chunks, starting the local stages on early chunks.
+        *
+        * Rank 0 permutes the input chunk by chunk (in the gather form permuted[j] = input[rev(j)])
+        * and sends each chunk with MPI_Isend as soon as it is ready, first chunk of every rank
+        * first. The other ranks run all the stages that fit inside one chunk (len <= chunk_n)
+        * on every chunk as soon as it arrives; rank 0 does the same on its own block once
+        * every send is posted.
+        *
+        * @param log_n The number of bits of the global index.
+        * @param local_data Receives the local block.
+        * @param local_n The local block length.
+        * @param chunk_n The chunk length.
+        * @param inverse Whether to perform the inverse FFT stages.
+        */
+        void scatter_pipelined(size_t log_n, std::vector<T>& local_data, int local_n, int chunk_n, bool inverse) {
+            int chunks = local_n / chunk_n;
+            std::vector<MPI_Request> requests;
+
+            if (rank == 0) {
+                const std::vector<T>& in = *(this->input);
+                std::vector<T> staging(static_cast<size_t>(size - 1) * local_n);
+                requests.reserve(static_cast<size_t>(size - 1) * chunks);
+
+                for (int c = 0; c < chunks; ++c) {
+                    for (int dest = 1; dest < size; ++dest) {
+                        T* chunk = staging.data() + static_cast<size_t>(dest - 1) * local_n + static_cast<size_t>(c) * chunk_n;
+                        size_t first = static_cast<size_t>(dest) * local_n + static_cast<size_t>(c) * chunk_n;
+
+                        #pragma omp parallel for schedule(static)
+                        for (size_t k = 0; k < static_cast<size_t>(chunk_n); ++k) {
+                            chunk[k] = in[reverse_bits(first + k, log_n)];
+                        }
+
+                        requests.emplace_back();
+                        MPI_Isend(chunk, chunk_n, MPI_C_DOUBLE_COMPLEX, dest, CHUNK_TAG + c, comm, &requests.back());
+                        local_traffic += static_cast<long long>(chunk_n) * sizeof(T);
+                    }
+                }
+
+                // Own block while the chunks are on the wire
+                for (int c = 0; c < chunks; ++c) {
+                    T* chunk = local_data.data() + static_cast<size_t>(c) * chunk_n;
+                    size_t first = static_cast<size_t>(c) * chunk_n;
+
+                    #pragma omp parallel for schedule(static)
+                    for (size_t k = 0; k < static_cast<size_t>(chunk_n); ++k) {
+                        chunk[k] = in[reverse_bits(first + k, log_n)];
+                    }
+                    local_stages(chunk, chunk_n, inverse);
+                }
+
+                MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+            } else {
+                requests.resize(chunks);
+                for (int c = 0; c < chunks; ++c) {
+                    MPI_Irecv(local_data.data() + static_cast<size_t>(c) * chunk_n, chunk_n, MPI_C_DOUBLE_COMPLEX,
+                              0, CHUNK_TAG + c, comm, &requests[c]);
+                }
+
+                // Local stages on whichever chunk arrives first
+                for (int done = 0; done < chunks; ++done) {
+                    int c = 0;
+                    MPI_Waitany(chunks, requests.data(), &c, MPI_STATUS_IGNORE);
+                    T* chunk = local_data.data() + static_cast<size_t>(c) * chunk_n;
+                    local_stages(chunk, chunk_n, inverse);
+                }
+            }
+        }
+
+        /**
+        * @brief Runs the remaining stages, streaming each finished chunk of the last stage to rank 0.
+        *
+        * Rank 0 posts one MPI_Irecv per remote chunk directly into the output before the
+        * stages start; the other ranks send each chunk of the last stage as soon as it is computed.
+        *
+        * @param local_data The local block, with the stages up to chunk_n already applied.
+        * @param global_n The total transform length.
+        * @param local_n The local block length.
+        * @param chunk_n The chunk length.
+        * @param inverse Whether to perform the inverse FFT stages.
+        */
+        void stages_and_gather_pipelined(std::vector<T>& local_data, int global_n, int local_n, int chunk_n, bool inverse) {
+            int chunks = local_n / chunk_n;
+            std::vector<MPI_Request> requests;
+            requests.reserve(rank == 0 ? static_cast<size_t>(size - 1) * chunks : chunks);
+
+            if (rank == 0) {
+                for (int src = 1; src < size; ++src) {
+                    for (int c = 0; c < chunks; ++c) {
+                        T* target = this->output_data() + static_cast<size_t>(src) * local_n + static_cast<size_t>(c) * chunk_n;
+                        requests.emplace_back();
+                        MPI_Irecv(target, chunk_n, MPI_C_DOUBLE_COMPLEX, src, CHUNK_TAG + c, comm, &requests.back());
+                    }
+                }
+            }
+
+            distributed_stages(local_data, global_n, local_n, inverse, 2 * chunk_n,
+                [&](size_t offset, size_t count) {
+                    if (rank == 0) {
+                        std::copy(local_data.begin() + offset, local_data.begin() + offset + count,
+                                  this->output_data() + offset);
+                    } else {
+                        requests.emplace_back();
+                        MPI_Isend(local_data.data() + offset, static_cast<int>(count), MPI_C_DOUBLE_COMPLEX,
+                                  0, CHUNK_TAG + static_cast<int>(offset / count), comm, &requests.back());
+                        local_traffic += static_cast<long long>(count) * sizeof(T);
+                    }
+                });
+
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+        }
+
+        /**
+        * @brief Broadcasts the transform length and the real-signal flag from rank 0.
+        * @param global_n Set to the input length on every rank.
+        * @param is_real Set to true on every rank if rank 0 read a purely real signal.
+        */
+        void broadcast_setup(int& global_n, bool& is_real) {
+            // Both in one broadcast: the size in the high bits, the flag in the lowest one
+            size_t setup = 0;
+            if (rank == 0) {
+                setup = this->input->size() * 2 + (this->real_input ? 1 : 0);
+            }
+            channel->broadcast(setup, 0);
+            global_n = static_cast<int>(setup / 2);
+            is_real = (setup & 1) != 0;
+        }
+
+        /**
+        * @brief Checks the broadcast transform length on every rank, so that all of them throw together.
+        * @param global_n The transform length.
+        * @throws std::invalid_argument If global_n is not a power of 2 or not a multiple of the number of ranks.
+        */
+        void check_size(int global_n) const {
+            if ((global_n & (global_n - 1)) != 0 || global_n % size != 0) {
+                throw std::invalid_argument("Input size must be a power of 2 and a multiple of the number of ranks");
+            }
+        }
+
+        /**
+        * @brief Runs a planned transform: no setup broadcast, allocation or twiddle computation.
+        *
+        * Same algorithm as executeFFT(), using the buffers, tables and persistent
+        * requests (or window) prepared by plan(). Rank 0 only broadcasts whether its
+        * input has the planned size, so that a mismatch stops every rank.
+        *
+        * @param inverse If true, uses positive angles and normalizes the result.
+        * @throws std::invalid_argument On every rank, if rank 0's input size differs from the planned one.
+        */
+        void executePlanned(bool inverse) {
+            Timer t;
+            Plan& p = plan_state;
+            const size_t global_n = static_cast<size_t>(p.global_n);
+            const size_t local_n = static_cast<size_t>(p.local_n);
+
+            // Checked collectively: the other ranks would otherwise wait in the scatter forever
+            int matches = rank == 0 ? (this->input->size() == global_n ? 1 : 0) : 1;
+            MPI_Bcast(&matches, 1, MPI_INT, 0, p.comm);
+            if (!matches) {
+                throw std::invalid_argument("Input size does not match the planned size");
+            }
+
+            if (rank == 0) {
+                const std::vector<T>& in = *(this->input);
+
+                #pragma omp parallel for schedule(static)
+                for (size_t i = 0; i < global_n; ++i) {
+                    p.permuted_input[p.reversed[i]] = in[i];
+                }
+                this->prepare_output(global_n);
+            }
+
+            MPI_Scatter(rank == 0 ? p.permuted_input.data() : nullptr,
+                        p.local_n, MPI_C_DOUBLE_COMPLEX,
+                        p.local_data.data(),
+                        p.local_n, MPI_C_DOUBLE_COMPLEX,
+                        0, p.comm);
+
+            const long long block_bytes = static_cast<long long>(local_n) * sizeof(T);
+            local_traffic += rank == 0 ? (size - 1) * block_bytes : 0;
+
+            // Local stages with the tabulated twiddles (or the local engine)
+            if (local_engine) local_transform(p.local_data, inverse);
+            if (!local_engine && dataflow_block > 0) {
+                dataflow_stages(p.local_data.data(), local_n, inverse, 2, p.local_twiddles.data(), dataflow_block);
+            }
+            for (size_t len = 2; len <= local_n && !local_engine && dataflow_block == 0; len <<= 1) {
+                size_t stride = local_n / len;
+                #pragma omp parallel for collapse(2) schedule(static)
+                for (size_t i = 0; i < local_n; i += len) {
+                    for (size_t j = 0; j < len / 2; j++) {
+                        T w = inverse ? std::conj(p.local_twiddles[j * stride]) : p.local_twiddles[j * stride];
+                        T u = p.local_data[i + j];
+                        T v = p.local_data[i + j + len / 2] * w;
+                        p.local_data[i + j] = u + v;
+                        p.local_data[i + j + len / 2] = u - v;
+                    }
+                }
+            }
+
+            // Cross-rank stages on the persistent requests (or the persistent window)
+            for (size_t s = 0; s < p.partners.size(); ++s) {
+                if (p.win != MPI_WIN_NULL) {
+                    MPI_Win_fence(MPI_MODE_NOPUT | (s == 0 ? MPI_MODE_NOPRECEDE : 0), p.win);
+                    MPI_Get(p.buffer.data(), p.local_n, MPI_C_DOUBLE_COMPLEX,
+                            p.partners[s], 0, p.local_n, MPI_C_DOUBLE_COMPLEX, p.win);
+                    MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOSUCCEED, p.win);
+                } else {
+                    MPI_Startall(2, &p.requests[2 * s]);
+                    MPI_Waitall(2, &p.requests[2 * s], MPI_STATUSES_IGNORE);
+                }
+                local_traffic += block_bytes;
+
+                bool is_lower = rank < p.partners[s];
+                const std::vector<T>& twiddles = p.stage_twiddles[s];
+
+                #pragma omp parallel for schedule(static)
+                for (size_t i = 0; i < local_n; ++i) {
+                    T w = inverse ? std::conj(twiddles[i]) : twiddles[i];
+                    if (is_lower) {
+                        p.local_data[i] = p.local_data[i] + p.buffer[i] * w;
+                    } else {
+                        p.local_data[i] = p.buffer[i] - p.local_data[i] * w;
+                    }
+                }
+            }
+
+            MPI_Gather(p.local_data.data(), p.local_n, MPI_C_DOUBLE_COMPLEX,
+                    rank == 0 ? this->output_data() : nullptr, p.local_n, MPI_C_DOUBLE_COMPLEX, 0, p.comm);
+            local_traffic += rank == 0 ? 0 : block_bytes;
+
+            // Normalization (is needed for the inverse only!)
+            if (inverse && rank == 0) {
+                T* out = this->output_data();
+                #pragma omp parallel for
+                for (size_t i = 0; i < global_n; ++i) {
+                    out[i] /= static_cast<double>(global_n);
+                }
+            }
+
+            finish(t, global_n, inverse);
+        }
+
+        /**
+        * @brief The method that runs both Forward and Inverse Fast Fourier Transform using MPI and OpenMP.
+        * 
+        * This method performs the FFT in parallel. It handles data distribution,
+        * bit-reversal permutation (on rank 0), and butterfly operations.
+        * Stages where the butterfly width exceeds the local data size are computed
+        * by exchanging blocks between partner ranks.
+        *
+        * @param inverse If true, uses positive angles and normalizes the result.
+        */
+        void executeFFT(bool inverse) {
+            if (plan_state.global_n > 0) {
+                executePlanned(inverse);
+                return;
+            }
+
+            // Implementation of parallel FFT computation
+            Timer t;
+
+            // Setup
+            int global_n = 0;
+            bool is_real = false;
+            broadcast_setup(global_n, is_real);
+
+            // An empty input has no stage to run (and no block to split)
+            if (global_n == 0) {
+                if (rank == 0) this->prepare_output(0);
+                finish(t, 0, inverse);
+                return;
+            }
+            check_size(global_n);
+
+            // A real forward input of length N is packed into N/2 complex values
+            if (!inverse && is_real && global_n >= 2 * size) {
+                executeRealFFT(global_n);
+                finish(t, global_n, false);
+                return;
+            }
+
+            // Compute log_n
+            size_t log_n = 0;
+            while ((size_t(1) << log_n) < static_cast<size_t>(global_n)) log_n++; // casting global_n to size_t
+
+            int local_n = global_n / size;// Local partition size (Note: MPI counts must be int)
+            std::vector<T> local_data(local_n);// Each process gets a chunk of size local_n
+
+            int chunk_n = pipeline_chunk_length(local_n);
+            if (chunk_n > 0) {
+                // Chunked scatter and gather overlapping with the local and last stages
+                if (rank == 0) this->prepare_output(global_n);
+                scatter_pipelined(log_n, local_data, local_n, chunk_n, inverse);
+                stages_and_gather_pipelined(local_data, global_n, local_n, chunk_n, inverse);
+            } else {
+                // Bit reversal permutation
+                std::vector<T> permuted_input;
+                // rank 0 only (because just the root process handles the initial data permutation)
+                if (rank == 0) {
+                    permuted_input.resize(global_n);
+
+                    // "schedule(static)" because the work per iteration is identical
+                    #pragma omp parallel for schedule(static)
+                    for (size_t i = 0; i < static_cast<size_t>(global_n); ++i) { // casting gloabl_n to use size_t
+                        // Note that no two threads write to same 'j' (so it's safe)
+                        permuted_input[scatter_position(i, log_n, local_n)] = (*(this->input))[i];
+                    }
+
+                    // Prepare Output: resize output on rank 0 to hold final result later
+                    this->prepare_output(global_n);
+                }
+
+                // Scatter permuted input to all processes:
+                scatter_blocks(rank == 0 ? permuted_input.data() : nullptr, local_data.data(), local_n);
+
+                local_transform(local_data, inverse);
+                distributed_stages(local_data, global_n, local_n, inverse, 2 * local_n);
+
+                //Final Gather
+                gather_blocks(local_data.data(), rank == 0 ? this->output_data() : nullptr, local_n);
+            }
+
+            // Normalization (is needed for the inverse only!)
+            if (inverse && rank == 0) {
+                T* out = this->output_data();
+                #pragma omp parallel for
+                for (size_t i = 0; i < static_cast<size_t>(global_n); ++i) {
+                    out[i] /= static_cast<double>(global_n);
+                }
+            }
+
+            finish(t, global_n, inverse);
+        }
+
+        /**
+        * @brief Distributed forward FFT of a real signal (r2c).
+        *
+        * The N real samples are packed as z[k] = x[2k] + i*x[2k+1] and transformed with a
+        * distributed complex FFT of length N/2, so scatter, exchanges and gather move half
+        * the data. The Hermitian post-processing
+        *   X[k] = (Z[k] + conj(Z[N/2-k])) / 2 - i/2 * W^k * (Z[k] - conj(Z[N/2-k]))
+        * needs Z[N/2-k], which lives on rank size-1-rank (plus one element from rank
+        * size-rank), so a single extra partner exchange is enough.
+        * Rank 0 expands the gathered half spectrum into the full N-point output.
+        *
+        * @param global_n The number of real samples (a power of 2, at least 2 * size).
+        */
+        void executeRealFFT(int global_n) {
+            int half_n = global_n / 2;
+            int local_n = half_n / size;
+
+            size_t log_half = 0;
+            while ((size_t(1) << log_half) < static_cast<size_t>(half_n)) log_half++;
+
+            // Packing and bit reversal permutation on rank 0
+            std::vector<T> permuted_input;
+            if (rank == 0) {
+                permuted_input.resize(half_n);
+                const std::vector<T>& in = *(this->input);
+
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < static_cast<size_t>(half_n); ++k) {
+                    permuted_input[scatter_position(k, log_half, local_n)] = T(in[2 * k].real(), in[2 * k + 1].real());
+                }
+
+                this->prepare_output(global_n);
+            }
+
+            std::vector<T> local_data(local_n);
+            scatter_blocks(rank == 0 ? permuted_input.data() : nullptr, local_data.data(), local_n);
+
+            local_transform(local_data, false);
+            distributed_stages(local_data, half_n, local_n, false, 2 * local_n);
+
+            // Z[N/2 - k] for k = rank*local_n + i (i > 0) is element local_n - i of the mirror rank,
+            // while for i == 0 it is the first element of rank (size - rank) % size.
+            int mirror = size - 1 - rank;
+            int first_partner = (size - rank) % size;
+            std::vector<T> buffer(local_n);
+            T first_element;
+            sendrecv_values(local_data.data(), buffer.data(), local_n, mirror);
+            sendrecv_values(local_data.data(), &first_element, 1, first_partner);
+
+            // Z[0] is needed by rank 0 for the Nyquist bin X[N/2]
+            T z0 = local_data[0];
+
+            double angle = -2.0 * std::acos(-1.0) / global_n;
+            size_t start_k = static_cast<size_t>(rank) * local_n;
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < static_cast<size_t>(local_n); ++i) {
+                T z = local_data[i];
+                T z_mirror = std::conj(i == 0 ? first_element : buffer[local_n - i]);
+                T even = 0.5 * (z + z_mirror);
+                T odd = T(0.0, -0.5) * (z - z_mirror);
+                local_data[i] = even + std::polar(1.0, angle * static_cast<double>(start_k + i)) * odd;
+            }
+
+            // Gather the half spectrum X[0 .. N/2-1]
+            gather_blocks(local_data.data(), rank == 0 ? this->output_data() : nullptr, local_n);
+
+            // Hermitian symmetry gives the remaining bins
+            if (rank == 0) {
+                T* out = this->output_data();
+                out[half_n] = T(z0.real() - z0.imag(), 0.0);
+
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 1; k < static_cast<size_t>(half_n); ++k) {
+                    out[global_n - k] = std::conj(out[k]);
+                }
+            }
+        }
+
+        /**
+        * @brief Distributed inverse FFT of a Hermitian spectrum (c2r).
+        *
+        * Rank 0 folds the N-point spectrum into the N/2-point spectrum of
+        * z[n] = x[2n] + i*x[2n+1] while permuting it, then a distributed complex IFFT
+        * of length N/2 runs and rank 0 unpacks the real samples.
+        *
+        * @param global_n The spectrum length (a power of 2, at least 2 * size).
+        */
+        void executeRealIFFT(int global_n) {
+            int half_n = global_n / 2;
+            int local_n = half_n / size;
+
+            size_t log_half = 0;
+            while ((size_t(1) << log_half) < static_cast<size_t>(half_n)) log_half++;
+
+            // Folding and bit reversal permutation on rank 0
+            std::vector<T> permuted_input;
+            if (rank == 0) {
+                permuted_input.resize(half_n);
+                const std::vector<T>& in = *(this->input);
+                double angle = 2.0 * std::acos(-1.0) / global_n;
+
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < static_cast<size_t>(half_n); ++k) {
+                    T even = 0.5 * (in[k] + in[k + half_n]);
+                    T odd = 0.5 * (in[k] - in[k + half_n]) * std::polar(1.0, angle * static_cast<double>(k));
+                    permuted_input[scatter_position(k, log_half, local_n)] = even + T(0.0, 1.0) * odd;
+                }
+            }
+
+            std::vector<T> local_data(local_n);
+            scatter_blocks(rank == 0 ? permuted_input.data() : nullptr, local_data.data(), local_n);
+
+            local_transform(local_data, true);
+            distributed_stages(local_data, half_n, local_n, true, 2 * local_n);
+
+            // Reuse the permutation buffer to receive the packed samples
+            gather_blocks(local_data.data(), rank == 0 ? permuted_input.data() : nullptr, local_n);
+
+            // Unpacking and normalization
+            if (rank == 0) {
+                this->prepare_output(global_n);
+                T* out = this->output_data();
+
+                #pragma omp parallel for schedule(static)
+                for (size_t k = 0; k < static_cast<size_t>(half_n); ++k) {
+                    T z = permuted_input[k] / static_cast<double>(half_n);
+                    out[2 * k] = T(z.real(), 0.0);
+                    out[2 * k + 1] = T(z.imag(), 0.0);
+                }
+            }
+        }
+    
+
+    public:
+        /**
+         * @brief Constructs a Parallel FFT object.
+         * 
+         * Initializes MPI rank and size based on the provided communicator.
+         * 
+         * @param communicator The MPI communicator to use (default: MPI_COMM_WORLD).
+         */
+        Parallel(MPI_Comm communicator = MPI_COMM_WORLD)
+            : comm(communicator), channel(new MpiCommunicator<T>(communicator)) {
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+        }
+
+        /**
+         * @brief Constructs a Parallel FFT object on any Communicator (e.g. one ThreadCommunicator per thread).
+         *
+         * Without an MPI communicator the RMA exchange and persistent plans are unavailable
+         * and scatter and gather are not pipelined.
+         *
+         * @param communicator The endpoint of this participant.
+         */
+        explicit Parallel(std::unique_ptr<Communicator<T>> communicator)
+            : rank(communicator->rank()), size(communicator->size()), comm(MPI_COMM_NULL),
+              channel(std::move(communicator)) {}
+
+        /**
+         * @brief Destructor. Frees the persistent plan while MPI is still active.
+         */
+        ~Parallel() override {
+            int finalized = 0;
+            MPI_Finalized(&finalized);
+            if (!finalized) releasePlan();
+        }
+        
+        /**
+         * @brief Selects how blocks are exchanged in the cross-rank stages.
+         * @param mode ExchangeMode::SendRecv (default) or ExchangeMode::RMA. Must be the same on all ranks.
+         * @throws std::invalid_argument For ExchangeMode::RMA without an MPI communicator.
+         */
+        void setExchangeMode(ExchangeMode mode) {
+            if (mode == ExchangeMode::RMA && comm == MPI_COMM_NULL) {
+                throw std::invalid_argument("RMA exchanges need an MPI communicator");
+            }
+            exchange = mode;
+        }
+
+        /**
+         * @brief Streams scatter and gather in chunks so that computation overlaps communication.
+         *
+         * Each local block is sent in the given number of chunks; ranks start the local stages
+         * on the chunks that already arrived, and the chunks of the last stage are gathered
+         * while the rest of it is still being computed. Only used for complex transforms with
+         * more than one rank of an MPI communicator and when the local block splits evenly.
+         *
+         * @param chunks Number of chunks per local block (1 disables pipelining). Must be the same on all ranks.
+         */
+        void setPipelineChunks(int chunks) {
+            pipeline_chunks = std::max(chunks, 1);
+        }
+
+        /**
+         * @brief Selects how the local butterfly stages are scheduled on the OpenMP threads.
+         *
+         * With a block length, the local block is cut into blocks of that many elements and
+         * every stage runs as tasks on pairs of blocks, each starting as soon as the two
+         * blocks it reads are final (see dataflow_stages()). With 0, every stage is one
+         * parallel loop ending in a barrier. The cross-rank stages are not affected.
+         *
+         * @param block The block length (a power of 2, default DATAFLOW_BLOCK), or 0.
+         * @throws std::invalid_argument If block is neither 0 nor a power of 2.
+         */
+        void setDataflowBlock(size_t block) {
+            if (block != 0 && (block & (block - 1)) != 0) {
+                throw std::invalid_argument("Dataflow block length must be 0 or a power of 2");
+            }
+            dataflow_block = block;
+        }
+
+        /**
+         * @brief Selects the format of the values in scatter, gather and two-sided exchanges.
+         *
+         * WireFormat::Float and WireFormat::BFloat16 halve or quarter the bytes on the wire at the
+         * cost of rounding every exchanged component. The RMA exchange, the pipelined scatter/gather
+         * and planned transforms always move full doubles.
+         *
+         * @param format The wire format. Must be the same on all ranks.
+         */
+        void setWireFormat(WireFormat format) {
+            wire_format = format;
+        }
+
+        /**
+         * @brief Selects the cheapest wire format whose rounding error per exchanged component is within the bound.
+         * @param relative_error The accepted relative error (0 keeps the lossless format).
+         */
+        void setCompressionErrorBound(double relative_error) {
+            wire_format = wire_format_for_error(relative_error);
+        }
+
+        /**
+         * @brief Delegates the local sub-transform (every stage up to the local block length) to a single-node engine.
+         *
+         * Rank 0 then scatters each rank the decimated subsequence x[m*size + s] in natural
+         * order, the engine computes its DFT, and only the cross-rank stages run in Parallel.
+         * Faster node-local kernels thus speed up the distributed transform directly.
+         * The pipelined scatter/gather is not used while an engine is set.
+         *
+         * @param engine The engine (e.g. Iterative), or nullptr for the built-in butterfly stages.
+         *               Must be set the same way on all ranks, before plan().
+         */
+        void setLocalEngine(std::unique_ptr<Fourier<T>> engine) {
+            local_engine = std::move(engine);
+        }
+
+        /**
+         * @brief Returns the bytes sent between all ranks by the last transform (valid on rank 0).
+         */
+        long long getTraffic() const {
+            return traffic;
+        }
+
+        /**
+         * @brief Prepares a persistent plan for transforms of length n (collective).
+         *
+         * Duplicates the communicator and sets up, once, the bit-reversal table, the
+         * permutation, local and exchange buffers, the twiddles of every stage and either
+         * the MPI_Send_init/MPI_Recv_init pairs of every cross-rank stage or, in
+         * ExchangeMode::RMA, the window over the local block. Following compute() and
+         * reverseCompute() calls skip all the setup (the size broadcast is reduced to a
+         * one-flag size check) and always run complex transforms of length n; rank 0's
+         * input must have that size.
+         *
+         * @param n The transform length (a power of 2, multiple of the number of ranks).
+         * @throws std::invalid_argument If n cannot be distributed over the ranks, or without an MPI communicator.
+         */
+        void plan(int n) {
+            if (comm == MPI_COMM_NULL) {
+                throw std::invalid_argument("Plans need an MPI communicator");
+            }
+            if (n <= 0 || (n & (n - 1)) != 0 || n % size != 0) {
+                throw std::invalid_argument("Plan size must be a power of 2 and a multiple of the number of processes");
+            }
+            releasePlan();
+
+            Plan& p = plan_state;
+            p.global_n = n;
+            p.local_n = n / size;
+            MPI_Comm_dup(comm, &p.comm);
+
+            size_t log_n = 0;
+            while ((size_t(1) << log_n) < static_cast<size_t>(n)) log_n++;
+
+            if (rank == 0) {
+                p.reversed.resize(n);
+                p.permuted_input.resize(n);
+                for (size_t i = 0; i < static_cast<size_t>(n); ++i) {
+                    p.reversed[i] = scatter_position(i, log_n, p.local_n);
+                }
+            }
+
+            p.local_data.resize(p.local_n);
+            p.buffer.resize(p.local_n);
+            p.local_twiddles.resize(p.local_n / 2);
+            double local_angle = -2.0 * std::acos(-1.0) / p.local_n;
+            for (int j = 0; j < p.local_n / 2; ++j) {
+                p.local_twiddles[j] = std::polar(1.0, local_angle * j);
+            }
+
+            for (int len = 2 * p.local_n; len <= n; len <<= 1) {
+                int group_size = len / 2 / p.local_n;
+                size_t start_j = static_cast<size_t>(rank % group_size) * p.local_n;
+                double angle = -2.0 * std::acos(-1.0) / len;
+
+                std::vector<T> twiddles(p.local_n);
+                for (size_t i = 0; i < static_cast<size_t>(p.local_n); ++i) {
+                    twiddles[i] = std::polar(1.0, angle * static_cast<double>(start_j + i));
+                }
+                p.stage_twiddles.push_back(std::move(twiddles));
+                p.partners.push_back(rank ^ group_size);
+            }
+
+            if (exchange == ExchangeMode::RMA && size > 1) {
+                MPI_Win_create(p.local_data.data(), static_cast<MPI_Aint>(p.local_n * sizeof(T)), sizeof(T),
+                               MPI_INFO_NULL, p.comm, &p.win);
+            } else {
+                p.requests.resize(2 * p.partners.size());
+                for (size_t s = 0; s < p.partners.size(); ++s) {
+                    MPI_Send_init(p.local_data.data(), p.local_n, MPI_C_DOUBLE_COMPLEX, p.partners[s],
+                                  static_cast<int>(s), p.comm, &p.requests[2 * s]);
+                    MPI_Recv_init(p.buffer.data(), p.local_n, MPI_C_DOUBLE_COMPLEX, p.partners[s],
+                                  static_cast<int>(s), p.comm, &p.requests[2 * s + 1]);
+                }
+            }
+        }
+
+        /**
+         * @brief Prepares a persistent plan for the size of rank 0's current input (collective).
+         */
+        void plan() {
+            if (comm == MPI_COMM_NULL) {
+                throw std::invalid_argument("Plans need an MPI communicator");
+            }
+            int n = rank == 0 ? static_cast<int>(this->input->size()) : 0;
+            MPI_Bcast(&n, 1, MPI_INT, 0, comm);
+            plan(n);
+        }
+
+        /**
+         * @brief Frees the persistent plan (collective); later calls go back to the unplanned path.
+         */
+        void releasePlan() {
+            Plan& p = plan_state;
+            if (p.global_n == 0) return;
+
+            for (MPI_Request& request : p.requests) {
+                MPI_Request_free(&request);
+            }
+            if (p.win != MPI_WIN_NULL) {
+                MPI_Win_free(&p.win);
+            }
+            MPI_Comm_free(&p.comm);
+            plan_state = Plan();
+        }
+
+        /**
+         * @brief Computes the forward Fast Fourier Transform using MPI and OpenMP.
+         *
+         * If read() detected a real signal, the half-length real-to-complex transform is used
+         * (unless a plan was prepared with plan()).
+         */
+        void compute() override{
+            // Forward FFT computation
+            executeFFT(false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the inverse Fast Fourier Transform using MPI and OpenMP.
+         */
+        void reverseCompute() override {
+            // Inverse FFT computation
+            executeFFT(true); // inverse = true
+        }
+
+        /**
+         * @brief Computes the inverse FFT of a Hermitian spectrum, producing a real signal.
+         *
+         * Use it when the spectrum comes from a real signal (e.g. the output of compute()
+         * on a real input): only half of the data is scattered, exchanged and gathered.
+         * Falls back to the complex inverse when the size is too small to be split.
+         */
+        void reverseComputeReal() {
+            Timer t;
+
+            int global_n = 0;
+            bool is_real = false;
+            broadcast_setup(global_n, is_real);
+
+            if (global_n < 2 * size) {
+                executeFFT(true);
+                return;
+            }
+            check_size(global_n);
+
+            executeRealIFFT(global_n);
+            finish(t, global_n, true);
+        }
+
+        /**
+         * @brief Prints the statistics of the Parallel FFT/IFFT execution.
+         * @param label "FFT" or "IFFT"
+         */
+        void printStats(const std::string& label) override {
+            if (rank == 0) {
+                std::cout << "Parallel " << label << " Duration: " << this->duration << " ms" << std::endl;
+                std::cout << "Parallel " << label << " Exchanged: " << traffic << " bytes" << std::endl;
+            }
+        }
+};
+
 #endif // PARALLEL_HPP
\ No newline at end of file
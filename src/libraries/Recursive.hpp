@@ -11,6 +11,7 @@
 #include <cmath>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
 
 using namespace std;
 
@@ -86,8 +87,8 @@ class Recursive : public Fourier<T> {
 
             // Algorithm
             vector<T> result = recursive(*(this->input));
-            this->output = make_unique<vector<T>>(result);
-            this->duration = t.stop_and_return();
+            std::copy(result.begin(), result.end(), this->prepare_output(result.size()));
+            this->record_duration(t, result.size(), false);
         }
         
         /**
@@ -107,8 +108,8 @@ class Recursive : public Fourier<T> {
                 it /= N;
             }
 
-            this->output = make_unique<vector<T>>(Y);
-            this->duration = t.stop_and_return();
+            std::copy(Y.begin(), Y.end(), this->prepare_output(Y.size()));
+            this->record_duration(t, Y.size(), true);
         }
 
         /**
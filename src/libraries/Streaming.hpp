@@ -0,0 +1,286 @@
+/**
+ * @file Streaming.hpp
+ * @brief Header file for the real-time streaming FFT (lock-free rings and a pinned worker).
+ */
+#ifndef STREAMING_HPP
+#define STREAMING_HPP
+
+#include "Kernels.hpp"
+#include "../utilities/LatencyHistogram.hpp"
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @class SpscRing
+ * @brief Lock-free bounded queue for exactly one producer thread and one consumer thread.
+ *
+ * The producer only writes head and the consumer only writes tail (release stores,
+ * acquire loads), so no locks or read-modify-write atomics are needed. Each side
+ * keeps a cached copy of the other side's index and reloads it only when the ring
+ * looks full (or empty), and the indices live on separate cache lines, to keep the
+ * two cores from invalidating each other's lines on every element.
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+class SpscRing {
+    private:
+        std::vector<T> slots;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> head{0}; ///< Next slot to write (producer).
+        size_t cached_tail = 0;                  ///< Producer's copy of tail.
+
+        alignas(64) std::atomic<size_t> tail{0}; ///< Next slot to read (consumer).
+        size_t cached_head = 0;                  ///< Consumer's copy of head.
+
+    public:
+        /**
+         * @brief Creates a ring holding at least capacity elements (rounded up to a power of 2).
+         * @param capacity The minimum capacity (at least 1).
+         */
+        explicit SpscRing(size_t capacity) {
+            size_t size = 1;
+            while (size < std::max<size_t>(capacity, 1)) size <<= 1;
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        /**
+         * @brief Appends up to count elements (producer only).
+         * @return size_t The number of elements actually written (0 if the ring is full).
+         */
+        size_t push(const T* values, size_t count) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h - cached_tail + count > slots.size()) {
+                cached_tail = tail.load(std::memory_order_acquire);
+            }
+            const size_t n = std::min(count, slots.size() - (h - cached_tail));
+            for (size_t i = 0; i < n; ++i) {
+                slots[(h + i) & mask] = values[i];
+            }
+            head.store(h + n, std::memory_order_release);
+            return n;
+        }
+
+        /**
+         * @brief Appends one element (producer only).
+         * @return bool False if the ring is full.
+         */
+        bool push(const T& value) {
+            return push(&value, 1) == 1;
+        }
+
+        /**
+         * @brief Removes up to count elements (consumer only).
+         * @return size_t The number of elements actually read (0 if the ring is empty).
+         */
+        size_t pop(T* values, size_t count) {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (cached_head - t < count) {
+                cached_head = head.load(std::memory_order_acquire);
+            }
+            const size_t n = std::min(count, cached_head - t);
+            for (size_t i = 0; i < n; ++i) {
+                values[i] = slots[(t + i) & mask];
+            }
+            tail.store(t + n, std::memory_order_release);
+            return n;
+        }
+
+        /**
+         * @brief Removes one element (consumer only).
+         * @return bool False if the ring is empty.
+         */
+        bool pop(T& value) {
+            return pop(&value, 1) == 1;
+        }
+
+        /**
+         * @brief Returns the capacity of the ring.
+         */
+        size_t capacity() const {
+            return slots.size();
+        }
+};
+
+/**
+ * @class StreamingFFT
+ * @brief Transforms a live sample stream in fixed-size blocks with bounded latency.
+ *
+ * A producer thread feeds samples with push() into a lock-free ring; a worker thread
+ * (optionally pinned to one CPU) cuts them into blocks of n samples, transforms each
+ * block in place and hands it to the consumer through a second ring. The consumer
+ * reads blocks with acquire() and gives them back with release(), which returns the
+ * buffer to the worker through a third ring. All blocks and tables are allocated by
+ * the constructor: the hot path has no allocation, no lock and no OpenMP fork (the
+ * serial radix-2 kernel keeps the per-block latency predictable). The transform time
+ * of every block goes into a preallocated latency histogram.
+ *
+ * If the consumer keeps every block, the worker stalls and push() starts returning
+ * short counts: back-pressure reaches the producer instead of growing memory.
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class StreamingFFT {
+    private:
+        size_t n;
+        int cpu;
+        std::vector<T> twiddles;
+        std::vector<T> storage;   ///< blocks_in_flight buffers of n samples.
+
+        SpscRing<T> samples;      ///< Producer -> worker.
+        SpscRing<T*> ready;       ///< Worker -> consumer (transformed blocks).
+        SpscRing<T*> free_blocks; ///< Consumer -> worker (buffers to refill).
+
+        std::atomic<bool> running{false};
+        std::thread worker;
+
+        T* block = nullptr;       ///< Block being filled by the worker (kept across stop()/start()).
+        size_t filled = 0;        ///< Samples already in block.
+
+        LatencyRecorder latencies; ///< Transform time of every block (written by the worker).
+
+        /**
+        * @brief The worker: fill a free block, transform it, publish it, repeat.
+        */
+        void work() {
+#ifdef __linux__
+            if (cpu >= 0) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            }
+#endif
+            while (running.load(std::memory_order_relaxed)) {
+                if (block == nullptr && !free_blocks.pop(block)) {
+                    std::this_thread::yield(); // consumer holds every buffer
+                    continue;
+                }
+
+                filled += samples.pop(block + filled, n - filled);
+                if (filled < n) {
+                    std::this_thread::yield(); // waiting for samples
+                    continue;
+                }
+
+                const auto start = std::chrono::steady_clock::now();
+                fft_in_place(block, n, twiddles, false);
+                latencies.record(n, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - start).count());
+                ready.push(block); // never full: it can hold every buffer
+                block = nullptr;
+                filled = 0;
+            }
+        }
+
+    public:
+        /**
+         * @brief Preallocates the rings, the blocks and the twiddles.
+         *
+         * @param block_n The samples per block (a power of 2).
+         * @param blocks_in_flight The number of block buffers shared by worker and consumer.
+         * @param pin_cpu The CPU to pin the worker to (-1 = no pinning).
+         * @throws std::invalid_argument If block_n is not a power of 2 or no block is in flight.
+         */
+        StreamingFFT(size_t block_n, size_t blocks_in_flight = 8, int pin_cpu = -1)
+            : n(block_n), cpu(pin_cpu),
+              samples(block_n * std::max<size_t>(blocks_in_flight, 1)),
+              ready(blocks_in_flight), free_blocks(blocks_in_flight) {
+            if (block_n == 0 || (block_n & (block_n - 1)) != 0) {
+                throw std::invalid_argument("Block size must be a power of 2");
+            }
+            if (blocks_in_flight == 0) {
+                throw std::invalid_argument("At least one block must be in flight");
+            }
+
+            twiddles = make_twiddles<T>(n);
+            latencies.prepare(n);
+            storage.resize(blocks_in_flight * n);
+            for (size_t b = 0; b < blocks_in_flight; ++b) {
+                free_blocks.push(storage.data() + b * n);
+            }
+        }
+
+        /**
+         * @brief Stops the worker.
+         */
+        ~StreamingFFT() {
+            stop();
+        }
+
+        StreamingFFT(const StreamingFFT&) = delete;
+        StreamingFFT& operator=(const StreamingFFT&) = delete;
+
+        /**
+         * @brief Starts the worker thread.
+         */
+        void start() {
+            if (running.exchange(true)) return;
+            worker = std::thread(&StreamingFFT::work, this);
+        }
+
+        /**
+         * @brief Stops and joins the worker thread.
+         *
+         * The samples of an incomplete block stay in its buffer, which the worker keeps:
+         * the block is completed and published after the next start().
+         */
+        void stop() {
+            running.store(false);
+            if (worker.joinable()) worker.join();
+        }
+
+        /**
+         * @brief Feeds samples to the stream (producer thread only).
+         * @param data The samples.
+         * @param count The number of samples.
+         * @return size_t How many samples were accepted (fewer than count when the ring is full).
+         */
+        size_t push(const T* data, size_t count) {
+            return samples.push(data, count);
+        }
+
+        /**
+         * @brief Returns the next transformed block, or nullptr if none is ready (consumer thread only).
+         * @return const T* The n spectrum values of the block, valid until release().
+         */
+        const T* acquire() {
+            T* block = nullptr;
+            return ready.pop(block) ? block : nullptr;
+        }
+
+        /**
+         * @brief Gives a block returned by acquire() back to the worker (consumer thread only).
+         */
+        void release(const T* block) {
+            free_blocks.push(const_cast<T*>(block));
+        }
+
+        /**
+         * @brief Returns the transform time of every block so far (read it after stop()).
+         */
+        const LatencyRecorder& latency() const {
+            return latencies;
+        }
+
+        /**
+         * @brief Returns the number of samples per block.
+         */
+        size_t blockSize() const {
+            return n;
+        }
+};
+
+#endif // STREAMING_HPP
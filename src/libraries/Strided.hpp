@@ -0,0 +1,188 @@
+/**
+ * @file Strided.hpp
+ * @brief Header file for batched transforms over strided data layouts.
+ */
+#ifndef STRIDED_HPP
+#define STRIDED_HPP
+
+#include "Kernels.hpp"
+#include "TimedTransform.hpp"
+#include "../utilities/Timer.hpp"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Where the elements of a batch of transforms live in memory.
+ *
+ * Element k of transform b is at base[b * dist + k * stride] (both in elements,
+ * like the howmany/stride/dist arguments of FFTW's advanced interface).
+ * Examples for a rows x cols row-major matrix: the rows are {rows, 1, cols},
+ * the columns are {cols, cols, 1}.
+ */
+struct Layout {
+    size_t howmany;   ///< Number of transforms.
+    ptrdiff_t stride; ///< Distance between consecutive elements of one transform.
+    ptrdiff_t dist;   ///< Distance between the first elements of consecutive transforms.
+};
+
+/**
+ * @class StridedPlan
+ * @brief Computes howmany DFTs of length n read and written through arbitrary strides.
+ *
+ * Columns of a matrix or one field of an array of records are transformed where they
+ * are, with no gather/scatter by the caller. Unit-stride transforms are computed
+ * directly in the output buffer; strided ones are copied through a per-thread
+ * contiguous buffer. When the transforms are closer to each other than the elements
+ * inside a transform (|dist| < |stride|, e.g. matrix columns), a block of
+ * neighbouring transforms is copied at once, so every cache line that is touched
+ * serves the whole block instead of a single element.
+ *
+ * Any length is supported (DftKernel: radix-2 for powers of 2, mixed radix and Rader otherwise).
+ *
+ * @tparam T The data type of the signal (usually std::complex<double>).
+ */
+template <typename T>
+class StridedPlan : public TimedTransform {
+    private:
+        size_t n;
+        Layout in_layout;
+        Layout out_layout;
+        DftKernel<T> kernel;
+
+        /**
+         * @brief Number of transforms copied together by the blocked copies.
+         */
+        size_t block;
+
+        /**
+        * @brief Transforms a contiguous buffer in place (inverse as conj(DFT(conj(x))) / n).
+        */
+        void transform(T* data, T* scratch, bool inverse) const {
+            if (inverse) {
+                for (size_t k = 0; k < n; ++k) data[k] = std::conj(data[k]);
+            }
+            kernel(data, scratch);
+            if (inverse) {
+                for (size_t k = 0; k < n; ++k) data[k] = std::conj(data[k]) / static_cast<double>(n);
+            }
+        }
+
+        /**
+        * @brief Transforms every element of the batch.
+        * @param in The input base pointer.
+        * @param out The output base pointer (may be equal to in if both layouts match).
+        * @param inverse Whether to compute inverse DFTs.
+        */
+        void execute(const T* in, T* out, bool inverse) {
+            Timer t;
+            const size_t howmany = in_layout.howmany;
+            const ptrdiff_t is = in_layout.stride, id = in_layout.dist;
+            const ptrdiff_t os = out_layout.stride, od = out_layout.dist;
+
+            if (is == 1 && os == 1) {
+                // Contiguous transforms: work directly in the output
+                #pragma omp parallel
+                {
+                    std::vector<T> scratch(kernel.scratch_size());
+                    #pragma omp for schedule(static)
+                    for (size_t b = 0; b < howmany; ++b) {
+                        const T* src = in + static_cast<ptrdiff_t>(b) * id;
+                        T* dst = out + static_cast<ptrdiff_t>(b) * od;
+                        if (src != dst) std::copy(src, src + n, dst);
+                        transform(dst, scratch.data(), inverse);
+                    }
+                }
+            } else {
+                const size_t blocks = (howmany + block - 1) / block;
+
+                #pragma omp parallel
+                {
+                    std::vector<T> buffer(block * n);
+                    std::vector<T> scratch(kernel.scratch_size());
+
+                    #pragma omp for schedule(static)
+                    for (size_t blk = 0; blk < blocks; ++blk) {
+                        const size_t first = blk * block;
+                        const size_t count = std::min(block, howmany - first);
+
+                        // Element-major copy: with small dist the inner loop reads neighbouring memory
+                        for (size_t k = 0; k < n; ++k) {
+                            const T* src = in + static_cast<ptrdiff_t>(k) * is + static_cast<ptrdiff_t>(first) * id;
+                            for (size_t b = 0; b < count; ++b) {
+                                buffer[b * n + k] = src[static_cast<ptrdiff_t>(b) * id];
+                            }
+                        }
+
+                        for (size_t b = 0; b < count; ++b) {
+                            transform(buffer.data() + b * n, scratch.data(), inverse);
+                        }
+
+                        for (size_t k = 0; k < n; ++k) {
+                            T* dst = out + static_cast<ptrdiff_t>(k) * os + static_cast<ptrdiff_t>(first) * od;
+                            for (size_t b = 0; b < count; ++b) {
+                                dst[static_cast<ptrdiff_t>(b) * od] = buffer[b * n + k];
+                            }
+                        }
+                    }
+                }
+            }
+
+            this->record_duration(t, n, inverse);
+        }
+
+    public:
+        /**
+         * @brief Prepares the transforms of a batch with the given input and output layouts.
+         *
+         * In-place use (same base pointer for input and output) requires identical layouts.
+         *
+         * @param length The length of every transform.
+         * @param input Where the transforms are read.
+         * @param output Where the results are written (same howmany as input).
+         * @throws std::invalid_argument If the length is 0 or the layouts disagree on howmany.
+         */
+        StridedPlan(size_t length, Layout input, Layout output)
+            : TimedTransform("Strided", true), n(length), in_layout(input), out_layout(output),
+              kernel(length == 0 ? 1 : length), block(1) {
+            if (length == 0) {
+                throw std::invalid_argument("Transform length must be positive");
+            }
+            if (input.howmany != output.howmany) {
+                throw std::invalid_argument("Input and output layouts must have the same number of transforms");
+            }
+
+            // Block neighbouring transforms when they are closer than the elements of one transform,
+            // sized so that the contiguous copies of a block stay around 256 KiB
+            const bool interleaved = std::abs(input.dist) < std::abs(input.stride) ||
+                                     std::abs(output.dist) < std::abs(output.stride);
+            if (interleaved) {
+                block = std::max<size_t>(1, std::min<size_t>(16, (256 * 1024) / (n * sizeof(T))));
+            }
+        }
+
+        /**
+         * @brief Computes the forward DFT of every transform of the batch.
+         * @param in The input base pointer.
+         * @param out The output base pointer.
+         */
+        void compute(const T* in, T* out) {
+            execute(in, out, false); // inverse = false
+        }
+
+        /**
+         * @brief Computes the normalized inverse DFT of every transform of the batch.
+         * @param in The input base pointer.
+         * @param out The output base pointer.
+         */
+        void reverseCompute(const T* in, T* out) {
+            execute(in, out, true); // inverse = true
+        }
+};
+
+#endif // STRIDED_HPP
@@ -0,0 +1,87 @@
+/**
+ * @file TimedTransform.hpp
+ * @brief Header file for the timing statistics shared by the standalone transform classes.
+ */
+#ifndef TIMED_TRANSFORM_HPP
+#define TIMED_TRANSFORM_HPP
+
+#include "../utilities/LatencyHistogram.hpp"
+#include "../utilities/Timer.hpp"
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+/**
+ * @class TimedTransform
+ * @brief Duration and latency bookkeeping of the classes that are not Fourier engines.
+ *
+ * The same statistics as Fourier: the duration of the last computation, and the
+ * latencies of every forward and inverse computation by size. Derived classes start
+ * a Timer and end every computation with record_duration().
+ */
+class TimedTransform {
+    private:
+        /**
+         * @brief Name printed in front of the statistics, e.g. "Strided".
+         */
+        std::string name;
+
+        /**
+         * @brief True if the class has an inverse: the latencies are then labelled FFT and IFFT.
+         */
+        bool invertible;
+
+    protected:
+        /**
+         * @brief Duration of the last computation in milliseconds.
+         */
+        long long duration;
+
+        /**
+         * @brief Latencies of every forward and inverse computation, by size.
+         */
+        LatencyRecorder forward_latency, inverse_latency;
+
+        /**
+         * @brief Creates empty statistics.
+         * @param label Name printed in front of the statistics.
+         * @param has_inverse True if the class computes inverse transforms too.
+         */
+        TimedTransform(const std::string& label, bool has_inverse)
+            : name(label), invertible(has_inverse), duration(0) {}
+
+        /**
+         * @brief Stops the timer of a computation: sets duration and records the latency.
+         * @param t The timer started at the beginning of the computation.
+         * @param n The size the latency is recorded under (e.g. transform length or frame count).
+         * @param inverse True for an inverse computation.
+         */
+        void record_duration(Timer& t, size_t n, bool inverse = false) {
+            const long long ns = t.stop_and_return_ns();
+            duration = ns / 1000000;
+            (inverse ? inverse_latency : forward_latency).record(n, ns);
+        }
+
+    public:
+        /**
+         * @brief Prints the duration of the last computation.
+         * @param label What was computed, e.g. "FFT" or "MFCC".
+         */
+        void printStats(const std::string& label) const {
+            std::cout << name << " " << label << " Duration: " << duration << " ms" << std::endl;
+        }
+
+        /**
+         * @brief Prints the latency percentiles of every computation run so far, by size.
+         */
+        void printLatency() const {
+            if (!invertible) {
+                forward_latency.report(name);
+                return;
+            }
+            forward_latency.report(name + " FFT");
+            inverse_latency.report(name + " IFFT");
+        }
+};
+
+#endif // TIMED_TRANSFORM_HPP
@@ -12,10 +12,1368 @@
 #include <vector>
 #include <cmath>
 #include <string>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <sstream>
+#include <cstdio>
+#include <exception>
+#include <omp.h>
 #include "libraries/Fourier.hpp"
 #include "libraries/Iterative.hpp"
 #include "libraries/Recursive.hpp"
 #include "libraries/Parallel.hpp"
+#include "libraries/Batch.hpp"
+#include "libraries/Distributed.hpp"
+#include "libraries/Arbitrary.hpp"
+#include "libraries/Composed.hpp"
+#include "libraries/Streaming.hpp"
+#include "libraries/Hilbert.hpp"
+#include "libraries/Mfcc.hpp"
+#include "libraries/ConstantQ.hpp"
+#include "libraries/CrossSpectral.hpp"
+#include "libraries/Strided.hpp"
+#include "libraries/MultiDim.hpp"
+#include "utilities/Roofline.hpp"
+#include "utilities/IoBenchmark.hpp"
+#include "utilities/Comparison.hpp"
+
+/**
+ * @brief Applies the optional "--option=value" arguments (argv[3] onwards) to a Parallel engine.
+ *
+ * Supported options:
+ *   --exchange=sendrecv|rma  Two-sided or one-sided exchange in the cross-rank stages.
+ *   --chunks=<k>             Pipelined scatter/gather in k chunks per rank.
+ *   --plan                   Persistent plan (buffers, twiddles, persistent requests) built after reading.
+ *   --wire=double|float|bf16 Format of the values in scatter, gather and two-sided exchanges.
+ *   --wire-error=<e>         Cheapest wire format with relative error per component <= e.
+ *   --local=iterative|recursive  Single-node engine computing the local sub-transforms.
+ *   --dataflow-block=<n>     Block length of the task dataflow of the local stages (0: one loop per stage).
+ *
+ * @param engine The Parallel engine to configure.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ */
+static void configureParallel(Parallel<std::complex<double>>& engine, int argc, char* argv[]) {
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--exchange=rma") {
+            engine.setExchangeMode(ExchangeMode::RMA);
+        } else if (option == "--exchange=sendrecv") {
+            engine.setExchangeMode(ExchangeMode::SendRecv);
+        } else if (option.rfind("--chunks=", 0) == 0) {
+            engine.setPipelineChunks(std::stoi(option.substr(9)));
+        } else if (option == "--wire=double") {
+            engine.setWireFormat(WireFormat::Double);
+        } else if (option == "--wire=float") {
+            engine.setWireFormat(WireFormat::Float);
+        } else if (option == "--wire=bf16") {
+            engine.setWireFormat(WireFormat::BFloat16);
+        } else if (option.rfind("--wire-error=", 0) == 0) {
+            engine.setCompressionErrorBound(std::stod(option.substr(13)));
+        } else if (option.rfind("--dataflow-block=", 0) == 0) {
+            engine.setDataflowBlock(std::stoul(option.substr(17)));
+        } else if (option == "--local=iterative") {
+            engine.setLocalEngine(std::make_unique<Iterative<std::complex<double>>>());
+        } else if (option == "--local=recursive") {
+            engine.setLocalEngine(std::make_unique<Recursive<std::complex<double>>>());
+        }
+    }
+}
+
+/**
+ * @brief Builds a persistent plan on a Parallel engine if "--plan" was given (collective).
+ *
+ * @param fft The engine, after read(); ignored if it is not a Parallel engine.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ */
+static void planParallel(Fourier<std::complex<double>>* fft, int argc, char* argv[]) {
+    auto* parallel = dynamic_cast<Parallel<std::complex<double>>*>(fft);
+    if (parallel == nullptr) return;
+    for (int i = 3; i < argc; ++i) {
+        if (std::string(argv[i]) == "--plan") {
+            parallel->plan();
+        }
+    }
+}
+
+/**
+ * @brief Creates a Distributed engine from the optional arguments (argv[3] onwards).
+ *
+ * Supported options:
+ *   --backend=threads|mpi  Threads sharing memory in this process (default) or MPI processes.
+ *   --ranks=<p>            Number of threads of the threads backend (default 4).
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return Distributed<std::complex<double>>* The new engine.
+ */
+static Distributed<std::complex<double>>* makeDistributed(int argc, char* argv[]) {
+    Backend backend = Backend::Threads;
+    int ranks = 4;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--backend=mpi") {
+            backend = Backend::MPI;
+        } else if (option == "--backend=threads") {
+            backend = Backend::Threads;
+        } else if (option.rfind("--ranks=", 0) == 0) {
+            ranks = std::stoi(option.substr(8));
+        }
+    }
+    return new Distributed<std::complex<double>>(backend, ranks);
+}
+
+/**
+ * @brief Reads the input of an engine from a text file or, if it starts with the block file magic, a block-compressed file.
+ *
+ * @param fft The engine.
+ * @param path The input file.
+ * @param pad If true, zero-pads the input to the next power of 2.
+ * @return bool True if the file holds a real signal.
+ * @throws std::runtime_error If the file cannot be opened or is corrupted.
+ */
+static bool readInput(Fourier<std::complex<double>>* fft, const char* path, bool pad = true) {
+    return is_block_file(path) ? fft->readCompressed(path, pad) : fft->read(path, pad);
+}
+
+/**
+ * @brief Parses "--compressed[=double|float|bf16]": the spectrum goes to output.fftz instead of output.txt.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @param format Set to the precision of the stored values (double if not given).
+ * @return bool True if the option is present.
+ */
+static bool compressedOutput(int argc, char* argv[], WireFormat& format) {
+    format = WireFormat::Double;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--compressed" || option == "--compressed=double") {
+            return true;
+        } else if (option == "--compressed=float") {
+            format = WireFormat::Float;
+            return true;
+        } else if (option == "--compressed=bf16") {
+            format = WireFormat::BFloat16;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the file given with "--archive=<file>", or an empty string.
+ *
+ * With this option rank 0 stores the input samples, losslessly, in a block-compressed
+ * file that later runs can read instead of the text file.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return std::string The path of the archive.
+ */
+static std::string archivePath(int argc, char* argv[]) {
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--archive=", 0) == 0) {
+            return option.substr(10);
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Returns the file given with "--map-output=<file>", or an empty string.
+ *
+ * With this option the forward transform writes its result straight into a
+ * memory-mapped binary file instead of output.txt.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return std::string The path of the mapped output file.
+ */
+static std::string mappedOutput(int argc, char* argv[]) {
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--map-output=", 0) == 0) {
+            return option.substr(13);
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Returns the count given with "--repeat=<k>" (default 1).
+ *
+ * Every transform is then run k times on the same input and the latency percentiles
+ * of the runs are printed, which shows the jitter a single duration hides.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return int The number of runs of every transform (at least 1).
+ */
+static int repeatCount(int argc, char* argv[]) {
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--repeat=", 0) == 0) {
+            return std::max(1, std::stoi(option.substr(9)));
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Reads every sample of a text file, one real or "(re,im)" value per line (or of a block-compressed file).
+ *
+ * @param input_file The text file of samples.
+ * @return std::vector<std::complex<double>> The samples, without padding.
+ * @throws std::runtime_error If the input file cannot be opened.
+ */
+static std::vector<std::complex<double>> readSamples(const std::string& input_file) {
+    if (is_block_file(input_file)) {
+        std::vector<std::complex<double>> samples(static_cast<size_t>(read_block_header(input_file).samples));
+        read_block_file(input_file, samples.data());
+        return samples;
+    }
+    std::ifstream in(input_file);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    std::vector<std::complex<double>> samples;
+    std::complex<double> value;
+    while (in >> value) samples.push_back(value);
+    return samples;
+}
+
+/**
+ * @brief Streams the samples of a text file through a StreamingFFT and writes every block spectrum.
+ *
+ * A producer thread feeds the samples as they would arrive from a device, the
+ * streaming worker transforms them block by block, and the calling thread consumes
+ * the spectra into output_Stream.txt (one block after the other), then the latency
+ * percentiles of the block transforms are printed. Trailing samples that do not
+ * fill a block are not transformed.
+ *
+ * Supported options (argv[3] onwards):
+ *   --block=<n>  Samples per block, a power of 2 (default 1024).
+ *   --cpu=<k>    CPU the streaming worker is pinned to (default: not pinned).
+ *
+ * @param input_file The text file of samples.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If the input file cannot be opened.
+ */
+static void runStreaming(const std::string& input_file, int argc, char* argv[]) {
+    size_t block = 1024;
+    int cpu = -1;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--block=", 0) == 0) {
+            block = std::stoul(option.substr(8));
+        } else if (option.rfind("--cpu=", 0) == 0) {
+            cpu = std::stoi(option.substr(6));
+        }
+    }
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+
+    StreamingFFT<std::complex<double>> stream(block, 8, cpu);
+    const size_t blocks = samples.size() / block;
+    std::ofstream out("output_Stream.txt");
+
+    Timer t;
+    stream.start();
+    std::thread producer([&]() {
+        size_t sent = 0;
+        while (sent < samples.size()) {
+            size_t accepted = stream.push(samples.data() + sent, samples.size() - sent);
+            if (accepted == 0) std::this_thread::yield();
+            sent += accepted;
+        }
+    });
+
+    for (size_t b = 0; b < blocks;) {
+        const std::complex<double>* spectrum = stream.acquire();
+        if (spectrum == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t k = 0; k < block; ++k) out << spectrum[k] << "\n";
+        stream.release(spectrum);
+        ++b;
+    }
+
+    producer.join();
+    stream.stop();
+    std::cout << "Streaming FFT: " << blocks << " blocks of " << block
+              << ", Duration: " << t.stop_and_return() << " ms" << std::endl;
+    stream.latency().report("Streaming FFT");
+}
+
+/**
+ * @brief Computes the analytic signal (or only the envelope) of the real samples of a text file.
+ *
+ * The whole signal is transformed in one fused in-memory pass (real FFT, one-sided
+ * mask, inverse FFT) without padding. The analytic signal x + i*H(x) is written to
+ * output_Analytic.txt; with "--envelope" only its magnitude is written, to
+ * output_Envelope.txt.
+ *
+ * @param input_file The text file of real samples (imaginary parts are ignored).
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If the input file cannot be opened.
+ */
+static void runHilbert(const std::string& input_file, int argc, char* argv[]) {
+    bool envelope_only = false;
+    for (int i = 3; i < argc; ++i) {
+        if (std::string(argv[i]) == "--envelope") envelope_only = true;
+    }
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    if (samples.empty()) return;
+    std::vector<double> x(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) x[i] = samples[i].real();
+
+    AnalyticSignal<std::complex<double>> hilbert(x.size());
+    if (envelope_only) {
+        hilbert.envelope(x.data(), x.data());
+        hilbert.printStats("Envelope");
+
+        std::ofstream out("output_Envelope.txt");
+        out << std::fixed << std::setprecision(6);
+        for (double value : x) out << value << "\n";
+    } else {
+        std::vector<std::complex<double>> analytic(x.size());
+        hilbert.compute(x.data(), analytic.data());
+        hilbert.printStats("Analytic");
+
+        std::ofstream out("output_Analytic.txt");
+        out << std::fixed << std::setprecision(6);
+        for (const std::complex<double>& value : analytic) out << value << "\n";
+    }
+}
+
+/**
+ * @brief Extracts MFCC (or log-mel) features from the audio samples of a text file.
+ *
+ * The features of every frame are written as raw doubles, frame after frame, to
+ * output_Mfcc.bin (frames x coefficients) or, with "--mel", output_Mel.bin
+ * (frames x mel bands); the matrix shape is printed.
+ *
+ * Supported options (argv[3] onwards):
+ *   --rate=<hz>    Sample rate of the audio (default 44100).
+ *   --frame=<n>    Samples per frame, even (default 2048).
+ *   --hop=<n>      Samples between frames (default 512).
+ *   --mels=<m>     Mel bands (default 40).
+ *   --mfcc=<c>     Cepstral coefficients kept (default 13).
+ *   --mel          Write the log-mel spectrogram instead of the MFCCs.
+ *
+ * @param input_file The text file of audio samples (e.g. from converter.py).
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If a file cannot be opened.
+ */
+static void runMfcc(const std::string& input_file, int argc, char* argv[]) {
+    MfccConfig config;
+    bool mel_only = false;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--rate=", 0) == 0) {
+            config.sample_rate = std::stod(option.substr(7));
+        } else if (option.rfind("--frame=", 0) == 0) {
+            config.frame = std::stoul(option.substr(8));
+        } else if (option.rfind("--hop=", 0) == 0) {
+            config.hop = std::stoul(option.substr(6));
+        } else if (option.rfind("--mels=", 0) == 0) {
+            config.mels = std::stoul(option.substr(7));
+        } else if (option.rfind("--mfcc=", 0) == 0) {
+            config.coefficients = std::stoul(option.substr(7));
+        } else if (option == "--mel") {
+            mel_only = true;
+        }
+    }
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    std::vector<double> audio(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) audio[i] = samples[i].real();
+
+    Mfcc<std::complex<double>> mfcc(config);
+    const size_t frames = mfcc.frames(audio.size());
+    const size_t width = mel_only ? config.mels : config.coefficients;
+    std::vector<double> features(frames * width);
+
+    if (mel_only) {
+        mfcc.melSpectrogram(audio.data(), audio.size(), features.data());
+        mfcc.printStats("Mel");
+    } else {
+        mfcc.compute(audio.data(), audio.size(), features.data());
+        mfcc.printStats("MFCC");
+    }
+
+    const char* output_file = mel_only ? "output_Mel.bin" : "output_Mfcc.bin";
+    std::ofstream out(output_file, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    out.write(reinterpret_cast<const char*>(features.data()), static_cast<std::streamsize>(features.size() * sizeof(double)));
+    std::cout << "Features: " << frames << " x " << width << " doubles in " << output_file << std::endl;
+}
+
+/**
+ * @brief Computes the constant-Q spectrogram of the audio samples of a text file.
+ *
+ * The magnitudes of the coefficients of every frame are written as raw doubles,
+ * frame after frame, to output_Cqt.bin (frames x bins); the matrix shape is printed.
+ *
+ * Supported options (argv[3] onwards):
+ *   --rate=<hz>    Sample rate of the audio (default 44100).
+ *   --fmin=<hz>    Centre frequency of the first bin (default 32.70, C1).
+ *   --bins=<k>     Number of bins (default 84).
+ *   --octave=<b>   Bins per octave (default 12).
+ *   --hop=<n>      Samples between frames (default 512).
+ *
+ * @param input_file The text file of audio samples (e.g. from converter.py).
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If a file cannot be opened.
+ */
+static void runConstantQ(const std::string& input_file, int argc, char* argv[]) {
+    ConstantQConfig config;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--rate=", 0) == 0) {
+            config.sample_rate = std::stod(option.substr(7));
+        } else if (option.rfind("--fmin=", 0) == 0) {
+            config.fmin = std::stod(option.substr(7));
+        } else if (option.rfind("--bins=", 0) == 0) {
+            config.bins = std::stoul(option.substr(7));
+        } else if (option.rfind("--octave=", 0) == 0) {
+            config.bins_per_octave = std::stoul(option.substr(9));
+        } else if (option.rfind("--hop=", 0) == 0) {
+            config.hop = std::stoul(option.substr(6));
+        }
+    }
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    std::vector<double> audio(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) audio[i] = samples[i].real();
+
+    ConstantQ<std::complex<double>> cqt(config);
+    const size_t frames = cqt.frames(audio.size());
+    std::vector<std::complex<double>> coefficients(frames * config.bins);
+    cqt.compute(audio.data(), audio.size(), coefficients.data());
+    cqt.printStats("CQT");
+
+    std::vector<double> magnitudes(coefficients.size());
+    for (size_t i = 0; i < coefficients.size(); ++i) magnitudes[i] = std::abs(coefficients[i]);
+
+    std::ofstream out("output_Cqt.bin", std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    out.write(reinterpret_cast<const char*>(magnitudes.data()), static_cast<std::streamsize>(magnitudes.size() * sizeof(double)));
+    std::cout << "Features: " << frames << " x " << config.bins << " doubles in output_Cqt.bin (frame length "
+              << cqt.frameLength() << ")" << std::endl;
+}
+
+/**
+ * @brief Estimates the cross-spectral density and coherence matrices of a multichannel recording.
+ *
+ * The text file holds one time step per line with one value per channel. The upper
+ * triangles (i <= j, row-major) of every frequency bin are written bin after bin:
+ * the complex densities to output_Csd.bin and the magnitude-squared coherences
+ * (doubles) to output_Coherence.bin.
+ *
+ * Supported options (argv[3] onwards):
+ *   --channels=<c>   Number of channels (required).
+ *   --segment=<n>    Samples per segment, even (default 256).
+ *   --overlap=<n>    Samples shared by consecutive segments (default: half a segment).
+ *   --rate=<hz>      Sample rate (default 1).
+ *
+ * @param input_file The text file of interleaved samples.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::invalid_argument If the number of channels is missing or does not divide the samples.
+ * @throws std::runtime_error If a file cannot be opened.
+ */
+static void runCrossSpectral(const std::string& input_file, int argc, char* argv[]) {
+    CrossSpectralConfig config;
+    size_t channels = 0;
+    bool overlap_given = false;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--channels=", 0) == 0) {
+            channels = std::stoul(option.substr(11));
+        } else if (option.rfind("--segment=", 0) == 0) {
+            config.segment = std::stoul(option.substr(10));
+        } else if (option.rfind("--overlap=", 0) == 0) {
+            config.overlap = std::stoul(option.substr(10));
+            overlap_given = true;
+        } else if (option.rfind("--rate=", 0) == 0) {
+            config.sample_rate = std::stod(option.substr(7));
+        }
+    }
+    if (!overlap_given) config.overlap = config.segment / 2;
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    if (channels == 0 || samples.size() % channels != 0) {
+        throw std::invalid_argument("--channels must divide the number of samples");
+    }
+
+    // Interleaved time steps -> one contiguous signal per channel
+    const size_t length = samples.size() / channels;
+    std::vector<double> signals(samples.size());
+    for (size_t t = 0; t < length; ++t) {
+        for (size_t c = 0; c < channels; ++c) {
+            signals[c * length + t] = samples[t * channels + c].real();
+        }
+    }
+
+    CrossSpectral<std::complex<double>> csd(channels, config);
+    csd.compute(signals.data(), length);
+    csd.printStats("CSD");
+
+    const std::vector<std::complex<double>>& matrices = csd.matrices();
+    std::vector<double> coherence;
+    coherence.reserve(matrices.size());
+    for (size_t f = 0; f < csd.frequencyBins(); ++f) {
+        for (size_t i = 0; i < channels; ++i) {
+            for (size_t j = i; j < channels; ++j) coherence.push_back(csd.coherence(f, i, j));
+        }
+    }
+
+    std::ofstream out("output_Csd.bin", std::ios::binary);
+    std::ofstream coh("output_Coherence.bin", std::ios::binary);
+    if (!out.is_open() || !coh.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    out.write(reinterpret_cast<const char*>(matrices.data()), static_cast<std::streamsize>(matrices.size() * sizeof(std::complex<double>)));
+    coh.write(reinterpret_cast<const char*>(coherence.data()), static_cast<std::streamsize>(coherence.size() * sizeof(double)));
+    std::cout << "Matrices: " << csd.frequencyBins() << " bins x " << channels * (channels + 1) / 2
+              << " upper-triangle values, " << csd.averagedSegments() << " segments averaged" << std::endl;
+}
+
+/**
+ * @brief Places Iterative, Recursive and Parallel on the roofline of the machine.
+ *
+ * Every rank first measures its sustained memory bandwidth (STREAM triad) and peak
+ * flop/s at the same time as the others; rank 0's figures are the ceiling of the
+ * single-process engines and their sum over the ranks the ceiling of Parallel.
+ * Then, for every size, each engine transforms the samples of the file (repeated
+ * cyclically up to the size) several times; the median time, the 5 n log2(n) flops
+ * and the estimated memory traffic (see fft_bytes()) give its point. The report is
+ * printed and written to output_Roofline.txt for plot_roofline.py.
+ *
+ * Supported options (argv[3] onwards):
+ *   --sizes=<lo>:<hi>  Transform sizes 2^lo .. 2^hi (default 10:20).
+ *   --repeat=<k>       Timed transforms per engine and size (default and minimum 3).
+ *   --cache=<KiB>      Cache capacity of the traffic estimate (default: last-level cache).
+ *   --stream=<MiB>     Size of each triad array (default: 4x the cache, at most 128 MiB).
+ *   Parallel options, see configureParallel().
+ *
+ * @param input_file The text file of samples.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If the input file cannot be opened.
+ * @throws std::invalid_argument If the file has no samples or the sizes are invalid.
+ */
+static void runRoofline(const std::string& input_file, int argc, char* argv[]) {
+    int rank = 0, ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    int lo = 10, hi = 20;
+    size_t cache = last_level_cache();
+    size_t stream_bytes = 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--sizes=", 0) == 0) {
+            const size_t colon = option.find(':', 8);
+            lo = std::stoi(option.substr(8, colon - 8));
+            hi = colon == std::string::npos ? lo : std::stoi(option.substr(colon + 1));
+        } else if (option.rfind("--cache=", 0) == 0) {
+            cache = std::stoul(option.substr(8)) << 10;
+        } else if (option.rfind("--stream=", 0) == 0) {
+            stream_bytes = std::stoul(option.substr(9)) << 20;
+        }
+    }
+    if (lo < 1 || hi < lo || hi > 30) {
+        throw std::invalid_argument("--sizes must be <lo>:<hi> with 1 <= lo <= hi <= 30");
+    }
+    if (stream_bytes == 0) stream_bytes = std::min<size_t>(4 * cache, size_t(128) << 20);
+    const int repeat = std::max(3, repeatCount(argc, argv));
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    if (samples.empty()) {
+        throw std::invalid_argument("The input file has no samples");
+    }
+
+    // Ceilings: all ranks probe at once, as they share the node(s) while Parallel runs
+    MachineLimits own;
+    MPI_Barrier(MPI_COMM_WORLD);
+    own.bandwidth = measure_bandwidth(std::max<size_t>(stream_bytes / sizeof(double), 1));
+    MPI_Barrier(MPI_COMM_WORLD);
+    own.peak = measure_peak_flops();
+
+    MachineLimits single = own, total = own;
+    single.label = "rank 0";
+    total.label = std::to_string(ranks) + (ranks == 1 ? " rank" : " ranks");
+    MPI_Allreduce(&own.bandwidth, &total.bandwidth, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&own.peak, &total.peak, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if (ranks == 1) single = total;
+
+    Roofline roofline;
+    const std::string names[] = {"Iterative", "Recursive", "Parallel"};
+    for (int e = lo; e <= hi; ++e) {
+        const size_t n = size_t(1) << e;
+        std::vector<std::complex<double>> signal(n);
+        for (size_t i = 0; i < n; ++i) signal[i] = samples[i % samples.size()];
+
+        for (int k = 0; k < 3; ++k) {
+            // Single-process engines run on rank 0 only, Parallel on every rank
+            const bool distributed = k == 2;
+            if (!distributed && rank != 0) continue;
+            if (distributed && n < static_cast<size_t>(2 * ranks)) continue;
+
+            std::unique_ptr<Fourier<std::complex<double>>> engine;
+            if (k == 0) {
+                engine.reset(new Iterative<std::complex<double>>());
+            } else if (k == 1) {
+                engine.reset(new Recursive<std::complex<double>>());
+            } else {
+                auto* parallel = new Parallel<std::complex<double>>();
+                configureParallel(*parallel, argc, argv);
+                engine.reset(parallel);
+            }
+            engine->setInput(signal);
+            planParallel(engine.get(), argc, argv);
+
+            // One untimed warm-up transform, then the median of the timed ones (ranks start together)
+            auto sync = [distributed] { if (distributed) MPI_Barrier(MPI_COMM_WORLD); };
+            engine->compute();
+            const double seconds = median_seconds(repeat, [&] { engine->compute(); }, sync);
+            if (rank == 0) {
+                roofline.add(names[k], n, seconds, distributed ? total : single, cache);
+            }
+        }
+    }
+
+    if (rank == 0) {
+        roofline.report();
+        roofline.write("output_Roofline.txt");
+        std::cout << "Roofline table written to output_Roofline.txt (plot: python3 plot_roofline.py)" << std::endl;
+    }
+}
+
+/**
+ * @brief Measures the I/O paths around the transforms: text parse/format, binary, mmap and compressed loads.
+ *
+ * For every size and for real and complex samples (taken from the input file,
+ * repeated cyclically up to the size), the following operations are timed (median of
+ * the runs) and reported in MB/s of file and samples/s:
+ *   write() / writeReal()  Fourier's text output path (complex / real), 1 thread;
+ *   read()                 Fourier's text input path, 1 thread;
+ *   format                 snprintf formatting of the same text, per thread count;
+ *   parse                  strtod parsing of the same text, per thread count;
+ *   binary                 pread() of raw doubles, per thread count;
+ *   mmap                   copy out of a read-only mapping of raw doubles, per thread count;
+ *   fftz                   decompression of a block-compressed file (see BlockFile.hpp), per thread count.
+ * The table is printed and written to output_IoBench.txt. Runs on rank 0 only.
+ *
+ * Supported options (argv[3] onwards):
+ *   --sizes=<lo>:<hi>    Sample counts 2^lo .. 2^hi (default 12:20).
+ *   --threads=<a,b,...>  Thread counts (default: 1, 2, 4, ... up to the OpenMP maximum).
+ *   --repeat=<k>         Timed runs per measurement (default and minimum 3).
+ *   --dir=<path>         Directory of the temporary files (default: current directory).
+ *   --cold               Evicts the file from the page cache before every load.
+ *
+ * @param input_file The text file of samples.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::runtime_error If a file cannot be opened, or a load returns the wrong number of samples.
+ * @throws std::invalid_argument If the file has no samples or the sizes are invalid.
+ */
+static void runIoBenchmark(const std::string& input_file, int argc, char* argv[]) {
+    int lo = 12, hi = 20;
+    std::vector<int> thread_counts;
+    std::string directory = ".";
+    bool cold = false;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--sizes=", 0) == 0) {
+            const size_t colon = option.find(':', 8);
+            lo = std::stoi(option.substr(8, colon - 8));
+            hi = colon == std::string::npos ? lo : std::stoi(option.substr(colon + 1));
+        } else if (option.rfind("--threads=", 0) == 0) {
+            std::stringstream list(option.substr(10));
+            std::string item;
+            while (std::getline(list, item, ',')) thread_counts.push_back(std::max(1, std::stoi(item)));
+        } else if (option.rfind("--dir=", 0) == 0) {
+            directory = option.substr(6);
+        } else if (option == "--cold") {
+            cold = true;
+        }
+    }
+    if (lo < 1 || hi < lo || hi > 30) {
+        throw std::invalid_argument("--sizes must be <lo>:<hi> with 1 <= lo <= hi <= 30");
+    }
+    if (thread_counts.empty()) {
+        const int max_threads = omp_get_max_threads();
+        for (int t = 1; t < max_threads; t <<= 1) thread_counts.push_back(t);
+        thread_counts.push_back(max_threads);
+    }
+    const int repeat = std::max(3, repeatCount(argc, argv));
+
+    const std::vector<std::complex<double>> samples = readSamples(input_file);
+    if (samples.empty()) {
+        throw std::invalid_argument("The input file has no samples");
+    }
+
+    IoReport report;
+    for (int e = lo; e <= hi; ++e) {
+        const size_t n = size_t(1) << e;
+        std::vector<std::complex<double>> signal(n);
+        for (size_t i = 0; i < n; ++i) signal[i] = samples[i % samples.size()];
+
+        for (const bool real : {true, false}) {
+            const std::string format = real ? "real" : "complex";
+            const std::string text = directory + "/iobench_" + format + ".txt";
+            const std::string copy = directory + "/iobench_" + format + "_format.txt";
+            const std::string binary = directory + "/iobench_" + format + ".bin";
+            const std::string blocks = directory + "/iobench_" + format + ".fftz";
+            auto evict = [&](const std::string& path) { return [&, path] { if (cold) drop_page_cache(path); }; };
+            auto add = [&](const std::string& operation, const std::string& path, int threads, double seconds) {
+                IoMeasurement m;
+                m.operation = operation;
+                m.format = format;
+                m.samples = n;
+                m.bytes = file_size(path);
+                m.threads = threads;
+                m.seconds = seconds;
+                report.add(m);
+            };
+            auto check = [n](size_t loaded) {
+                if (loaded != n) throw std::runtime_error("I/O benchmark loaded " + std::to_string(loaded) + " samples instead of " + std::to_string(n));
+            };
+
+            // Fourier's own paths: a forward and inverse round trip leaves the samples in the output
+            Iterative<std::complex<double>> engine;
+            engine.setInput(signal);
+            engine.compute();
+            engine.reuseOutputAsInput();
+            engine.reverseCompute();
+            add(real ? "writeReal()" : "write()", text, 1, median_seconds(repeat, [&] {
+                if (real) engine.writeReal(text.c_str()); else engine.write(text.c_str());
+            }));
+            add("read()", text, 1, median_seconds(repeat, [&] { engine.read(text.c_str()); }, evict(text)));
+
+            write_binary(binary, signal.data(), n, real);
+            write_block_file(blocks, signal.data(), n, real);
+            std::vector<std::complex<double>> decoded(n);
+            for (const int threads : thread_counts) {
+                add("format", text, threads, median_seconds(repeat, [&] {
+                    format_text_parallel(copy, signal.data(), n, real, threads);
+                }));
+                add("parse", text, threads, median_seconds(repeat, [&] {
+                    check(parse_text_parallel(text, threads).size());
+                }, evict(text)));
+                add("binary", binary, threads, median_seconds(repeat, [&] {
+                    check(load_binary_parallel(binary, real, threads).size());
+                }, evict(binary)));
+                add("mmap", binary, threads, median_seconds(repeat, [&] {
+                    check(load_mapped_parallel(binary, real, threads).size());
+                }, evict(binary)));
+                add("fftz", blocks, threads, median_seconds(repeat, [&] {
+                    read_block_file(blocks, decoded.data(), threads);
+                }, evict(blocks)));
+            }
+            std::remove(text.c_str());
+            std::remove(copy.c_str());
+            std::remove(binary.c_str());
+            std::remove(blocks.c_str());
+        }
+    }
+
+    report.report();
+    report.write("output_IoBench.txt");
+    std::cout << "I/O table written to output_IoBench.txt" << std::endl;
+}
+
+/**
+ * @brief Compares engines on one parse of the input, with the same warm-up and repetitions for all.
+ *
+ * Rank 0 parses the input file once into a read-only buffer (zero-padded to a power
+ * of 2) that every engine uses through shareInput(), without copying it. Each engine
+ * runs the warm-up transforms, then the timed ones, forward on the samples and inverse
+ * on one shared spectrum (the first engine's). The table gives the median times, the
+ * round-trip error max|IFFT(X) - x| and the maximum difference between the spectra of
+ * every pair of engines. It is printed and written to output_Compare.txt.
+ * Arbitrary needs no padding and gets the unpadded samples: when the input was padded,
+ * its spectrum has another length and is not compared with the other engines'.
+ * Collective: Parallel, Arbitrary and Distributed on the MPI backend run on every rank.
+ *
+ * Supported options (argv[3] onwards):
+ *   --engines=<a,b,...>  Among iterative, recursive, parallel, distributed, arbitrary, composed
+ *                        (default: iterative,recursive,parallel).
+ *   --warmup=<k>         Untimed transforms before the timed ones (default 1).
+ *   --repeat=<k>         Timed transforms (default and minimum 3).
+ *   Parallel options (see configureParallel(), --plan) and Distributed options (see makeDistributed()).
+ *
+ * @param input_file The text (or block-compressed) file of samples.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @throws std::invalid_argument If the file has no samples or an engine is unknown.
+ */
+static void runCompare(const std::string& input_file, int argc, char* argv[]) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    std::vector<std::string> engines = {"iterative", "recursive", "parallel"};
+    int warmup = 1;
+    bool mpi_backend = false;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--engines=", 0) == 0) {
+            engines.clear();
+            std::stringstream list(option.substr(10));
+            std::string item;
+            while (std::getline(list, item, ',')) engines.push_back(item);
+        } else if (option.rfind("--warmup=", 0) == 0) {
+            warmup = std::max(0, std::stoi(option.substr(9)));
+        } else if (option == "--backend=mpi") {
+            mpi_backend = true;
+        } else if (option == "--backend=threads") {
+            mpi_backend = false;
+        }
+    }
+    const int repeat = std::max(3, repeatCount(argc, argv));
+
+    // The only parse of the input; the other ranks never read an input
+    auto samples = std::make_shared<std::vector<std::complex<double>>>();
+    std::shared_ptr<const std::vector<std::complex<double>>> unpadded = samples;
+    std::exception_ptr parse_error;
+    bool real_signal = true;
+    if (rank == 0) {
+        try {
+            *samples = readSamples(input_file);
+        } catch (...) {
+            parse_error = std::current_exception();
+        }
+        size_t padded = 1;
+        while (padded < samples->size()) padded <<= 1;
+        if (padded != samples->size() && std::find(engines.begin(), engines.end(), "arbitrary") != engines.end()) {
+            unpadded = std::make_shared<const std::vector<std::complex<double>>>(*samples);
+        }
+        samples->resize(samples->empty() ? 0 : padded, std::complex<double>(0.0, 0.0));
+        for (const std::complex<double>& v : *samples) real_signal = real_signal && v.imag() == 0.0;
+    }
+
+    // Every rank stops on a failed parse, not only rank 0 (the others would wait in the first engine)
+    unsigned long long count = samples->size();
+    MPI_Bcast(&count, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    if (parse_error) std::rethrow_exception(parse_error);
+    if (count == 0) {
+        throw std::invalid_argument("The input file has no samples");
+    }
+
+    const std::shared_ptr<const std::vector<std::complex<double>>> input = samples;
+    std::shared_ptr<const std::vector<std::complex<double>>> spectrum = input;
+
+    Comparison comparison;
+    for (const std::string& name : engines) {
+        const bool collective = name == "parallel" || name == "arbitrary" || (name == "distributed" && mpi_backend);
+        if (!collective && rank != 0) continue;
+
+        std::unique_ptr<Fourier<std::complex<double>>> engine;
+        ComparedEngine row;
+        if (name == "iterative") {
+            engine.reset(new Iterative<std::complex<double>>());
+            row.engine = "Iterative";
+        } else if (name == "recursive") {
+            engine.reset(new Recursive<std::complex<double>>());
+            row.engine = "Recursive";
+        } else if (name == "parallel") {
+            auto* parallel = new Parallel<std::complex<double>>();
+            configureParallel(*parallel, argc, argv);
+            engine.reset(parallel);
+            row.engine = "Parallel";
+        } else if (name == "distributed") {
+            engine.reset(makeDistributed(argc, argv));
+            row.engine = "Distributed";
+        } else if (name == "arbitrary") {
+            engine.reset(new Arbitrary<std::complex<double>>());
+            row.engine = "Arbitrary";
+        } else if (name == "composed") {
+            engine.reset(new ThreadedComposed<std::complex<double>>());
+            row.engine = "Composed";
+        } else {
+            throw std::invalid_argument("Unknown engine: " + name);
+        }
+        const std::shared_ptr<const std::vector<std::complex<double>>> samples_in = name == "arbitrary" ? unpadded : input;
+        row.n = samples_in->size();
+
+        // Untimed runs, then the median of the timed ones (ranks start together)
+        auto sync = [collective] { if (collective) MPI_Barrier(MPI_COMM_WORLD); };
+        engine->shareInput(samples_in, real_signal);
+        planParallel(engine.get(), argc, argv);
+        for (int w = 0; w < warmup; ++w) engine->compute();
+        row.forward = median_seconds(repeat, [&] { engine->compute(); }, sync);
+
+        // The inverse runs on the shared spectrum, or on its own one for unpadded samples
+        std::shared_ptr<const std::vector<std::complex<double>>> inverse_in = spectrum;
+        if (rank == 0) {
+            row.spectrum = engine->getOutput();
+            if (samples_in != input) {
+                inverse_in = std::make_shared<const std::vector<std::complex<double>>>(row.spectrum);
+            } else if (spectrum == input) {
+                spectrum = inverse_in = std::make_shared<const std::vector<std::complex<double>>>(row.spectrum);
+            }
+        }
+
+        engine->shareInput(inverse_in, false);
+        for (int w = 0; w < warmup; ++w) engine->reverseCompute();
+        row.inverse = median_seconds(repeat, [&] { engine->reverseCompute(); }, sync);
+        if (rank == 0) {
+            row.roundtrip = max_abs_difference(engine->getOutput(), *samples_in);
+            comparison.add(std::move(row));
+        }
+    }
+
+    if (rank == 0) {
+        comparison.report();
+        comparison.write("output_Compare.txt");
+        std::cout << "Comparison table written to output_Compare.txt" << std::endl;
+    }
+}
+
+/**
+ * @brief Prints the result of one self-check (rank 0).
+ *
+ * @param name What was checked.
+ * @param error The maximum error relative to the largest reference value.
+ * @param bound The largest accepted error.
+ * @return bool True if the error is within the bound.
+ */
+static bool checkPassed(const std::string& name, double error, double bound) {
+    const bool passed = error <= bound;
+    std::cout << std::left << std::setw(44) << name << std::right << " relative error " << std::scientific
+              << std::setprecision(2) << error << (passed ? "  PASS" : "  FAIL") << std::defaultfloat << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Returns max |a[i] - b[i]| divided by the largest |b[i]| (or 1 if b is zero).
+ */
+static double relativeError(const std::vector<std::complex<double>>& a, const std::vector<std::complex<double>>& b) {
+    double scale = 0.0;
+    for (const std::complex<double>& v : b) scale = std::max(scale, std::abs(v));
+    return max_abs_difference(a, b) / (scale > 0.0 ? scale : 1.0);
+}
+
+/**
+ * @brief Returns the DFT of x by the O(n^2) definition (reference of the self-checks).
+ */
+static std::vector<std::complex<double>> directDft(const std::vector<std::complex<double>>& x) {
+    const size_t n = x.size();
+    std::vector<std::complex<double>> result(n);
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            result[k] += x[j] * std::polar(1.0, -2.0 * std::acos(-1.0) * static_cast<double>((j * k) % n) / static_cast<double>(n));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Runs the self-checks of the engines on the input samples (collective).
+ *
+ * Every check computes a transform with an engine and compares it with a reference
+ * computed independently (Iterative or a direct DFT), then prints one PASS/FAIL line:
+ *   Parallel forward, reuse, forward  compute(), reuseOutputAsInput(), compute() on a
+ *                                     real input: the second transform must be complex;
+ *   Parallel read, setInput, forward  read() of a real input, then setInput() of complex
+ *                                     samples: the transform must be complex;
+ *   Arbitrary 1000 four-step          distributed four-step transform (1000 = 25 x 40);
+ *   Arbitrary 1009 Bluestein          a prime length: Bluestein's algorithm on several
+ *                                     ranks (the local Rader kernel on one);
+ *   Arbitrary 1009 inverse            the inverse must give the samples back;
+ *   StridedPlan 12x10 columns         forward DFTs of the columns of a row-major matrix,
+ *                                     in place (length 12: mixed radix, blocked copies);
+ *   RealMultiDim 6x10 r2c             real 2D forward transform against the non-redundant
+ *                                     half of a direct 2D DFT;
+ *   RealMultiDim 6x10 c2r             its inverse must give the real samples back;
+ *   Hilbert cosine, n = 64 and 45     the analytic signal of cos(theta) is exp(i*theta),
+ *                                     for the packed (even) and the full (odd) forward FFT;
+ *   Mel peak of a tone                a tone at the centre of mel band 9 must peak there
+ *                                     (the error is the distance in bands);
+ *   CQT peak of a tone                the same for the constant-Q bin of A4 (440 Hz);
+ *   CrossSpectral 5 channels          every entry S(f)[i][j] of the Welch estimate (both
+ *                                     triangles) against a direct sum over the segments;
+ *   DftKernel n = ...                 mixed-radix and Rader lengths against the direct DFT:
+ *                                     primes whose p - 1 has only factors up to 13, 47
+ *                                     (46 = 2 x 23: zero-padded Rader convolution), 289 = 17^2
+ *                                     and 2018 = 2 x 1009 (Rader inside the mixed radix);
+ *   LZ4 bytes round trip              lz_compress() then lz_decompress() of noise and of
+ *                                     repetitive data, 0 to 200001 values (the error is the
+ *                                     number of mismatches);
+ *   Block file <format> round trip    write_block_file() then read_block_file() of the same
+ *                                     data: exact for Double, within the rounding of the
+ *                                     format for Float (2^-24) and BFloat16 (2^-8);
+ *   Block file corrupted offsets      match offsets before the start of the output and a
+ *                                     damaged block index must throw (the error is the
+ *                                     number of cases that did not).
+ *
+ * @param input_file The text (or block-compressed) file of samples.
+ * @return int The number of failed checks (the same on every rank).
+ * @throws std::runtime_error If the input file cannot be opened.
+ */
+static int runSelfCheck(const std::string& input_file) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    int failed = 0;
+    const double bound = 1e-9;
+
+    // A real input turns the first transform into the real-input path of Parallel
+    {
+        Parallel<std::complex<double>> parallel;
+        readInput(&parallel, input_file.c_str());
+        parallel.compute();
+        if (rank == 0) parallel.reuseOutputAsInput();
+        parallel.compute();
+
+        if (rank == 0) {
+            Iterative<std::complex<double>> reference;
+            readInput(&reference, input_file.c_str());
+            reference.compute();
+            reference.reuseOutputAsInput();
+            reference.compute();
+            failed += !checkPassed("Parallel forward, reuse, forward",
+                                   relativeError(parallel.getOutput(), reference.getOutput()), bound);
+        }
+    }
+
+    // setInput() after a real read() must not keep the real-input path
+    {
+        Parallel<std::complex<double>> parallel;
+        readInput(&parallel, input_file.c_str());
+        std::vector<std::complex<double>> complex_samples;
+        if (rank == 0) {
+            complex_samples = readSamples(input_file);
+            size_t padded = 1;
+            while (padded < complex_samples.size()) padded <<= 1;
+            complex_samples.resize(padded, std::complex<double>(0.0, 0.0));
+            for (size_t i = 0; i < complex_samples.size(); ++i) {
+                complex_samples[i] += std::complex<double>(0.0, std::cos(0.01 * static_cast<double>(i)));
+            }
+            parallel.setInput(complex_samples);
+        }
+        parallel.compute();
+
+        if (rank == 0) {
+            Iterative<std::complex<double>> reference;
+            reference.setInput(complex_samples);
+            reference.compute();
+            failed += !checkPassed("Parallel read, setInput, forward",
+                                   relativeError(parallel.getOutput(), reference.getOutput()), bound);
+        }
+    }
+
+    // Arbitrary lengths: a composite one (four-step) and a prime one (Bluestein)
+    for (size_t n : {static_cast<size_t>(1000), static_cast<size_t>(1009)}) {
+        std::vector<std::complex<double>> signal;
+        if (rank == 0) {
+            signal.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                signal[i] = std::complex<double>(std::cos(0.37 * static_cast<double>(i)), std::sin(0.011 * static_cast<double>(i * i % 97)));
+            }
+        }
+        Arbitrary<std::complex<double>> arbitrary;
+        if (rank == 0) arbitrary.setInput(signal);
+        arbitrary.compute();
+        if (rank == 0) {
+            failed += !checkPassed(n == 1000 ? "Arbitrary 1000 four-step" : "Arbitrary 1009 Bluestein",
+                                   relativeError(arbitrary.getOutput(), directDft(signal)), bound);
+            arbitrary.reuseOutputAsInput();
+        }
+        if (n == 1009) {
+            arbitrary.reverseCompute();
+            if (rank == 0) {
+                failed += !checkPassed("Arbitrary 1009 inverse", relativeError(arbitrary.getOutput(), signal), bound);
+            }
+        }
+    }
+
+    // The matrices of the single-process checks are filled with the input samples
+    std::vector<std::complex<double>> samples;
+    if (rank == 0) {
+        samples = readSamples(input_file);
+        if (samples.empty()) samples.assign(1, std::complex<double>(1.0, 0.0));
+    }
+
+    // Column transforms through strides, checked column by column
+    if (rank == 0) {
+        const size_t rows = 12, cols = 10;
+        std::vector<std::complex<double>> matrix(rows * cols);
+        for (size_t i = 0; i < matrix.size(); ++i) {
+            matrix[i] = samples[i % samples.size()] + std::complex<double>(0.0, std::sin(0.1 * static_cast<double>(i)));
+        }
+
+        std::vector<std::complex<double>> expected(rows * cols);
+        for (size_t c = 0; c < cols; ++c) {
+            std::vector<std::complex<double>> column(rows);
+            for (size_t r = 0; r < rows; ++r) column[r] = matrix[r * cols + c];
+            column = directDft(column);
+            for (size_t r = 0; r < rows; ++r) expected[r * cols + c] = column[r];
+        }
+
+        StridedPlan<std::complex<double>> plan(rows, {cols, static_cast<ptrdiff_t>(cols), 1},
+                                                     {cols, static_cast<ptrdiff_t>(cols), 1});
+        plan.compute(matrix.data(), matrix.data());
+        failed += !checkPassed("StridedPlan 12x10 columns", relativeError(matrix, expected), bound);
+    }
+
+    // Real 2D transform: the half spectrum of the direct 2D DFT, then back to the samples
+    if (rank == 0) {
+        const size_t rows = 6, cols = 10, half = cols / 2 + 1;
+        std::vector<double> image(rows * cols);
+        for (size_t i = 0; i < image.size(); ++i) image[i] = samples[i % samples.size()].real();
+
+        std::vector<std::complex<double>> full(rows * cols);
+        for (size_t r = 0; r < rows; ++r) {
+            std::vector<std::complex<double>> row(image.begin() + r * cols, image.begin() + (r + 1) * cols);
+            row = directDft(row);
+            std::copy(row.begin(), row.end(), full.begin() + r * cols);
+        }
+        std::vector<std::complex<double>> expected(rows * half);
+        for (size_t c = 0; c < half; ++c) {
+            std::vector<std::complex<double>> column(rows);
+            for (size_t r = 0; r < rows; ++r) column[r] = full[r * cols + c];
+            column = directDft(column);
+            for (size_t r = 0; r < rows; ++r) expected[r * half + c] = column[r];
+        }
+
+        RealMultiDim<std::complex<double>> transform({rows, cols});
+        std::vector<std::complex<double>> spectrum(transform.complex_size());
+        transform.compute(image.data(), spectrum.data());
+        failed += !checkPassed("RealMultiDim 6x10 r2c", relativeError(spectrum, expected), bound);
+
+        std::vector<double> restored(rows * cols);
+        transform.reverseCompute(spectrum.data(), restored.data());
+        failed += !checkPassed("RealMultiDim 6x10 c2r",
+                               relativeError(std::vector<std::complex<double>>(restored.begin(), restored.end()),
+                                             std::vector<std::complex<double>>(image.begin(), image.end())), bound);
+    }
+
+    // Analytic signal of a cosine with a whole number of periods
+    if (rank == 0) {
+        for (size_t n : {static_cast<size_t>(64), static_cast<size_t>(45)}) {
+            std::vector<double> wave(n);
+            std::vector<std::complex<double>> expected(n);
+            for (size_t i = 0; i < n; ++i) {
+                const double theta = 2.0 * std::acos(-1.0) * static_cast<double>(5 * i) / static_cast<double>(n);
+                wave[i] = std::cos(theta);
+                expected[i] = std::polar(1.0, theta);
+            }
+
+            AnalyticSignal<std::complex<double>> hilbert(n);
+            std::vector<std::complex<double>> analytic(n);
+            hilbert.compute(wave.data(), analytic.data());
+            failed += !checkPassed("Hilbert cosine, n = " + std::to_string(n), relativeError(analytic, expected), bound);
+        }
+    }
+
+    // Mel spectrogram of a pure tone: the loudest band is the one centred on the tone
+    if (rank == 0) {
+        MfccConfig config;
+        config.sample_rate = 16000.0;
+        config.frame = 1024;
+        config.hop = 1024;
+        config.mels = 20;
+        config.coefficients = 13;
+
+        // Centre of band 9 on the HTK mel scale of Mfcc (edges equally spaced from 0 to 8000 Hz)
+        const size_t band = 9;
+        const double top_mel = 2595.0 * std::log10(1.0 + 8000.0 / 700.0);
+        const double tone = 700.0 * (std::pow(10.0, top_mel * static_cast<double>(band + 1) / static_cast<double>(config.mels + 1) / 2595.0) - 1.0);
+
+        std::vector<double> audio(config.frame);
+        for (size_t i = 0; i < audio.size(); ++i) {
+            audio[i] = std::sin(2.0 * std::acos(-1.0) * tone * static_cast<double>(i) / config.sample_rate);
+        }
+        Mfcc<std::complex<double>> mfcc(config);
+        std::vector<double> mel(config.mels);
+        mfcc.melSpectrogram(audio.data(), audio.size(), mel.data());
+        const size_t peak = static_cast<size_t>(std::max_element(mel.begin(), mel.end()) - mel.begin());
+        failed += !checkPassed("Mel peak of a tone", std::abs(static_cast<double>(peak) - static_cast<double>(band)), bound);
+    }
+
+    // Constant-Q transform of A4: the largest coefficient is the bin of 440 Hz
+    if (rank == 0) {
+        ConstantQConfig config;
+        config.sample_rate = 8000.0;
+        config.fmin = 110.0;
+        config.bins_per_octave = 12;
+        config.bins = 36;
+        const size_t bin = 24; // two octaves above fmin
+
+        ConstantQ<std::complex<double>> cqt(config);
+        std::vector<double> audio(cqt.frameLength());
+        for (size_t i = 0; i < audio.size(); ++i) {
+            audio[i] = std::sin(2.0 * std::acos(-1.0) * cqt.frequency(bin) * static_cast<double>(i) / config.sample_rate);
+        }
+        std::vector<std::complex<double>> coefficients(config.bins);
+        cqt.compute(audio.data(), audio.size(), coefficients.data());
+        size_t peak = 0;
+        for (size_t k = 1; k < config.bins; ++k) {
+            if (std::abs(coefficients[k]) > std::abs(coefficients[peak])) peak = k;
+        }
+        failed += !checkPassed("CQT peak of a tone", std::abs(static_cast<double>(peak) - static_cast<double>(bin)), bound);
+    }
+
+    // Cross-spectral matrices against the Welch sum written out segment by segment
+    if (rank == 0) {
+        const size_t channels = 5, length = 72;
+        CrossSpectralConfig config;
+        config.segment = 16;
+        config.overlap = 8;
+        config.batch = 3; // several batches, the last one partial
+
+        std::vector<double> signals(channels * length);
+        for (size_t i = 0; i < signals.size(); ++i) {
+            signals[i] = samples[i % samples.size()].real() + std::sin(0.3 * static_cast<double>(i) + static_cast<double>(i / length));
+        }
+        CrossSpectral<std::complex<double>> csd(channels, config);
+        csd.compute(signals.data(), length);
+
+        const size_t hop = config.segment - config.overlap, bins = config.segment / 2 + 1;
+        const size_t segments = csd.segments(length);
+        std::vector<double> window(config.segment);
+        double power = 0.0;
+        for (size_t i = 0; i < config.segment; ++i) {
+            window[i] = 0.5 - 0.5 * std::cos(2.0 * std::acos(-1.0) * static_cast<double>(i) / static_cast<double>(config.segment));
+            power += window[i] * window[i];
+        }
+        std::vector<std::complex<double>> expected(bins * channels * channels), computed(expected.size());
+        for (size_t s = 0; s < segments; ++s) {
+            std::vector<std::vector<std::complex<double>>> spectra(channels);
+            for (size_t c = 0; c < channels; ++c) {
+                std::vector<std::complex<double>> segment(config.segment);
+                for (size_t i = 0; i < config.segment; ++i) segment[i] = signals[c * length + s * hop + i] * window[i];
+                spectra[c] = directDft(segment);
+            }
+            for (size_t f = 0; f < bins; ++f) {
+                const double factor = (f == 0 || f == bins - 1 ? 1.0 : 2.0) / (static_cast<double>(segments) * power);
+                for (size_t i = 0; i < channels; ++i) {
+                    for (size_t j = 0; j < channels; ++j) {
+                        expected[(f * channels + i) * channels + j] += factor * spectra[i][f] * std::conj(spectra[j][f]);
+                    }
+                }
+            }
+        }
+        for (size_t f = 0; f < bins; ++f) {
+            for (size_t i = 0; i < channels; ++i) {
+                for (size_t j = 0; j < channels; ++j) computed[(f * channels + i) * channels + j] = csd.csd(f, i, j);
+            }
+        }
+        failed += !checkPassed("CrossSpectral 5 channels", relativeError(computed, expected), bound);
+    }
+
+    // Local kernels of the lengths that are not powers of 2
+    if (rank == 0) {
+        for (size_t n : {17, 19, 23, 47, 97, 101, 127, 211, 289, 1009, 2018}) {
+            std::vector<std::complex<double>> signal(n);
+            for (size_t i = 0; i < n; ++i) {
+                signal[i] = samples[i % samples.size()] + std::complex<double>(0.0, std::cos(0.7 * static_cast<double>(i)));
+            }
+            const DftKernel<std::complex<double>> kernel(n);
+            std::vector<std::complex<double>> spectrum(signal), scratch(kernel.scratch_size());
+            kernel(spectrum.data(), scratch.data());
+            failed += !checkPassed("DftKernel n = " + std::to_string(n), relativeError(spectrum, directDft(signal)), bound);
+        }
+    }
+
+    // Block-compressed files: the LZ4 codec alone, then whole files in every format
+    if (rank == 0) {
+        const size_t lengths[] = {0, 1, 5, 13, 100, 65536, 200001};
+        std::vector<std::complex<double>> noise(200001), repetitive(200001);
+        unsigned long long state = 1;
+        for (size_t i = 0; i < noise.size(); ++i) {
+            double parts[2];
+            for (double& part : parts) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                part = static_cast<double>(state >> 11) * 0x1.0p-53 - 0.5;
+            }
+            noise[i] = std::complex<double>(parts[0], parts[1]);
+            repetitive[i] = std::complex<double>(0.25 * static_cast<double>(i % 7), -static_cast<double>(i % 3));
+        }
+
+        double mismatches = 0.0;
+        for (const std::vector<std::complex<double>>* data : {&noise, &repetitive}) {
+            for (size_t n : lengths) {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data->data());
+                std::vector<uint8_t> packed(lz_bound(n)), restored(n);
+                const size_t stored = lz_compress(bytes, n, packed.data());
+                if (lz_decompress(packed.data(), stored, restored.data(), n) != n ||
+                    !std::equal(restored.begin(), restored.end(), bytes)) {
+                    mismatches += 1.0;
+                }
+            }
+        }
+        failed += !checkPassed("LZ4 bytes round trip", mismatches, 0.0);
+
+        const std::string path = "selfcheck.fftz";
+        const std::pair<WireFormat, const char*> formats[] = {
+            {WireFormat::Double, "Double"}, {WireFormat::Float, "Float"}, {WireFormat::BFloat16, "BFloat16"}};
+        for (const auto& format : formats) {
+            double error = 0.0;
+            for (const std::vector<std::complex<double>>* data : {&noise, &repetitive}) {
+                for (size_t n : lengths) {
+                    const std::vector<std::complex<double>> values(data->begin(), data->begin() + n);
+                    write_block_file(path, values.data(), n, false, format.first);
+                    std::vector<std::complex<double>> restored(n);
+                    read_block_file(path, restored.data());
+                    error = std::max(error, relativeError(restored, values));
+                }
+            }
+            const double rounding = format.first == WireFormat::Double ? 0.0 : format.first == WireFormat::Float ? 0x1.0p-24 : 0x1.0p-8;
+            failed += !checkPassed(std::string("Block file ") + format.second + " round trip", error, rounding);
+        }
+
+        // Token: 1 literal and a match, whose offset reaches before the first output byte
+        int accepted = 0;
+        for (uint8_t offset : {0, 2}) {
+            const uint8_t block[] = {0x10, 'a', offset, 0x00};
+            uint8_t output[16];
+            try {
+                lz_decompress(block, sizeof(block), output, sizeof(output));
+                ++accepted;
+            } catch (const std::runtime_error&) {
+            }
+        }
+
+        // Block index pointing past the end of the file
+        write_block_file(path, repetitive.data(), repetitive.size(), false, WireFormat::Double);
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            const uint64_t past_end = 1ULL << 40;
+            file.seekp(static_cast<std::streamoff>(sizeof(BlockFileHeader) + sizeof(uint64_t)));
+            file.write(reinterpret_cast<const char*>(&past_end), sizeof(past_end));
+        }
+        try {
+            std::vector<std::complex<double>> restored(repetitive.size());
+            read_block_file(path, restored.data());
+            ++accepted;
+        } catch (const std::runtime_error&) {
+        }
+        std::remove(path.c_str());
+        failed += !checkPassed("Block file corrupted offsets", static_cast<double>(accepted), 0.0);
+    }
+
+    MPI_Bcast(&failed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    return failed;
+}
 
  /**
  * @brief Main function to execute FFT and cd ..algorithms.
@@ -27,8 +1385,23 @@
  * @param argc Number of command-line arguments.
  * @param argv Array of command-line arguments.
  *             argv[1]: Method selection 
- *                      (1: Iterative, 2: Recursive, 3: Parallel, 4: All methods).
- *             argv[2]: Input file path.
+ *                      (1: Iterative, 2: Recursive, 3: Parallel, 4: All methods, 5: Batch,
+ *                       6: Distributed on a pluggable backend, 7: Arbitrary length, no padding,
+ *                       8: Composed from compile-time policies, 9: Streaming in blocks,
+ *                       10: Analytic signal / envelope, 11: MFCC features,
+ *                       12: Constant-Q spectrogram, 13: Cross-spectral density / coherence,
+ *                       14: Roofline analysis of Iterative, Recursive and Parallel,
+ *                       15: I/O microbenchmarks (text parse/format, binary, mmap and compressed loads),
+ *                       16: Comparison of engines on one parse of the input,
+ *                       17: Self-checks of the engines against reference transforms).
+ *             argv[2]: Input file path (text, or block-compressed, see readInput()).
+ *             argv[3]: Length of every transform (Batch only, binary input file).
+ *             argv[3...]: --repeat=<k> (see repeatCount()), Parallel options, see configureParallel(), or Distributed
+ *                         options, see makeDistributed(), or Streaming options,
+ *                         see runStreaming(), or Roofline options, see runRoofline(), or I/O
+ *                         benchmark options, see runIoBenchmark(), or --compressed[=format]
+ *                         (see compressedOutput()) and --archive=<file> (see archivePath()), or
+ *                         comparison options, see runCompare().
  * @return int Exit status (0 for success, 1 for error).
  */
 
@@ -41,23 +1414,29 @@ int main(int argc, char* argv[]) {
     //Check on input arguments
     // 1 -> Select compute method (Iterative / Recursive / Parallel / All)
     // 2 -> Input file name
-    std::string methods[4] = {"Iterative", "Recursive", "Parallel", "All"};
+    // 3 -> Transform length (Batch only)
+    std::string methods[17] = {"Iterative", "Recursive", "Parallel", "All", "Batch", "Distributed", "Arbitrary", "Composed", "Streaming", "Hilbert", "Mfcc", "ConstantQ", "CrossSpectral", "Roofline", "IoBench", "Compare", "Check"};
     std::string input_file;
     int method = 0;
-    if (argc == 3) {
+    if (argc >= 3) {
         method = std::stoi(argv[1]);
         input_file = argv[2];
-        if (method < 1 || method > 4){
-            if (rank == 0) std::cerr << "Method must be between 1 and 4, use all" << std::endl;
+        if (method < 1 || method > 17){
+            if (rank == 0) std::cerr << "Method must be between 1 and 17, use all" << std::endl;
             method = 4;
         }
+        if (method == 5 && argc < 4) {
+            if (rank == 0) std::cerr << "Usage: 5 <input_file.bin> <transform_length>" << std::endl;
+            MPI_Finalize();
+            return 1;
+        }
 
         if (rank == 0) std::cerr << "Usage: " << methods[method-1] << " on file "<< input_file << std::endl;
     } else if (argc == 2){
         std::string input_file = argv[1];
         if (rank == 0) std::cerr << "Usage: All method on file " << input_file << std::endl;
     } else {
-        if (rank == 0) std::cerr << "Usage: <method (1-4)> <input_file>" << std::endl; //just one process prints the message
+        if (rank == 0) std::cerr << "Usage: <method (1-17)> <input_file> [transform_length | options]" << std::endl; //just one process prints the message
         MPI_Finalize();
         return 1;
     }
@@ -73,9 +1452,75 @@ int main(int argc, char* argv[]) {
         case 2:
             fft = new Recursive<std::complex<double>>();
             break;
-        case 3:
-            fft = new Parallel<std::complex<double>>();
+        case 3: {
+            auto* parallel = new Parallel<std::complex<double>>();
+            configureParallel(*parallel, argc, argv);
+            fft = parallel;
+            break;
+        }
+        case 6:
+            fft = makeDistributed(argc, argv);
+            break;
+        case 7:
+            fft = new Arbitrary<std::complex<double>>();
+            break;
+        case 8:
+            fft = new ThreadedComposed<std::complex<double>>();
             break;
+        case 5: {
+            // Many independent transforms stored back to back in a binary file
+            Batch<std::complex<double>> batch(std::stoul(argv[3]));
+
+            batch.compute(argv[2], "output_Batch.bin");
+            batch.printStats("FFT");
+
+            batch.reverseCompute("output_Batch.bin", "output_Batch_IFFT.bin");
+            batch.printStats("IFFT");
+
+            MPI_Finalize();
+            return 0;
+        }
+        case 9:
+            // Live stream simulation on a single process
+            if (rank == 0) runStreaming(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 10:
+            if (rank == 0) runHilbert(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 11:
+            if (rank == 0) runMfcc(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 12:
+            if (rank == 0) runConstantQ(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 13:
+            if (rank == 0) runCrossSpectral(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 14:
+            // Collective: Parallel and the ceilings involve every rank
+            runRoofline(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 15:
+            if (rank == 0) runIoBenchmark(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 16:
+            // Collective: Parallel runs on every rank
+            runCompare(input_file, argc, argv);
+            MPI_Finalize();
+            return 0;
+        case 17: {
+            // Collective: the exit status is 1 if any check failed
+            const int failed = runSelfCheck(input_file);
+            MPI_Finalize();
+            return failed == 0 ? 0 : 1;
+        }
         case 4:
             if (rank == 0) std::cout << "Running all methods..." << std::endl;
         
@@ -85,12 +1530,15 @@ int main(int argc, char* argv[]) {
                 new Parallel<std::complex<double>>()
             };
             std::string names[] = {"Iterative", "Recursive", "Parallel"};
+            configureParallel(*static_cast<Parallel<std::complex<double>>*>(runners[2]), argc, argv);
 
             for(int i=0; i<3; ++i) {
                 if (rank == 0) std::cout << "\n--- " << names[i] << " ---" << std::endl;
 
                 // if read return false, only reverseCompute
-                if (runners[i]->read(argv[2])) {
+                bool real_signal = readInput(runners[i], argv[2]);
+                planParallel(runners[i], argc, argv);
+                if (real_signal) {
                     // Forward FFT
                     runners[i]->compute();
                     if (rank == 0) runners[i]->printStats("FFT");
@@ -102,7 +1550,13 @@ int main(int argc, char* argv[]) {
 
                 // Inverse FFT
                 // Reload output as input
-                runners[i]->reverseCompute();
+                auto* parallel = dynamic_cast<Parallel<std::complex<double>>*>(runners[i]);
+                if (parallel != nullptr && real_signal) {
+                    // Spectrum of a real signal: half-length distributed inverse
+                    parallel->reverseComputeReal();
+                } else {
+                    runners[i]->reverseCompute();
+                }
                 if (rank == 0) runners[i]->printStats("IFFT");
                 if (rank == 0) runners[i]->writeReal(("output_" + names[i] + "_IFFT.txt").c_str());
             
@@ -114,25 +1568,63 @@ int main(int argc, char* argv[]) {
             break;
     }
 
-    if(fft->read(argv[2])){
-        fft->compute();
-        if (rank == 0) fft->printStats("FFT");
+    // The arbitrary-length engine transforms the samples as they are, without padding
+    const bool pad = method != 7;
+    bool real_signal = readInput(fft, argv[2], pad);
+    planParallel(fft, argc, argv);
+
+    const std::string archive = archivePath(argc, argv);
+    if (!archive.empty() && rank == 0) fft->archiveInput(archive.c_str());
 
-        if (rank == 0) fft->write("output.txt");
+    // The spectrum goes to output.txt, or to a block-compressed output.fftz
+    WireFormat stored_format;
+    const bool compressed = compressedOutput(argc, argv, stored_format);
+    const char* spectrum_file = compressed ? "output.fftz" : "output.txt";
 
-        if (method == 3) {
-            // Parallel implementation needs file read on all ranks after gather
-            MPI_Barrier(MPI_COMM_WORLD);
-            fft->read("output.txt");
+    const std::string mapped_file = mappedOutput(argc, argv);
+    if (!mapped_file.empty()) fft->mapOutput(mapped_file.c_str());
+
+    const int repeat = repeatCount(argc, argv);
+
+    if(real_signal){
+        for (int r = 0; r < repeat; ++r) fft->compute();
+        if (rank == 0) fft->printStats("FFT");
+
+        if (!mapped_file.empty()) {
+            // The spectrum is already in the mapped file: only rank 0 needs it back for the IFFT
+            if (rank == 0) fft->reuseOutputAsInput();
+            fft->unmapOutput();
         } else {
-            // Iterative/Recursive: keep everything in memory for IFFT
-            fft->reuseOutputAsInput();
+            if (rank == 0) {
+                if (compressed) {
+                    fft->writeCompressed(spectrum_file, stored_format);
+                } else {
+                    fft->write(spectrum_file);
+                }
+            }
+
+            if (method == 3 || method == 6 || method == 7) {
+                // Parallel/Distributed implementations need file read on all ranks after gather
+                MPI_Barrier(MPI_COMM_WORLD);
+                readInput(fft, spectrum_file, pad);
+            } else {
+                // Iterative/Recursive: keep everything in memory for IFFT
+                fft->reuseOutputAsInput();
+            }
         }
     }
    
     // Perform the inverse FFT (IFFT) for the selected method
-    fft->reverseCompute();
+    for (int r = 0; r < repeat; ++r) {
+        if (method == 3 && real_signal) {
+            // Spectrum of a real signal: half-length distributed inverse
+            static_cast<Parallel<std::complex<double>>*>(fft)->reverseComputeReal();
+        } else {
+            fft->reverseCompute();
+        }
+    }
     if (rank == 0) fft->printStats("IFFT");
+    if (rank == 0 && repeat > 1) fft->printLatency(methods[method - 1]);
     if (rank == 0) fft->writeReal("output_IFFT.txt");
     MPI_Finalize();
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+import matplotlib.pyplot as plt
+import sys
+import os
+
+def load(filename):
+    # Ceilings: "# ceiling <label> <bytes/s> <flop/s>", points: "<engine> <n> <seconds> <flops> <bytes> <ceiling>"
+    ceilings = {}
+    points = []
+    with open(filename, 'r') as f:
+        for line in f:
+            fields = line.split()
+            if not fields:
+                continue
+            if fields[0] == '#':
+                if len(fields) == 5 and fields[1] == 'ceiling':
+                    ceilings[fields[2]] = (float(fields[3]), float(fields[4]))
+                continue
+            engine, n, seconds, flops, bytes_moved, ceiling = fields[:6]
+            points.append((engine, int(n), float(seconds), float(flops), float(bytes_moved), ceiling))
+    return ceilings, points
+
+def main():
+    filename = sys.argv[1] if len(sys.argv) > 1 else 'output_Roofline.txt'
+    if not os.path.exists(filename):
+        print(f"Error: File {filename} not found.")
+        return
+
+    ceilings, points = load(filename)
+    if not points:
+        print(f"Error: No points in {filename}.")
+        return
+
+    intensities = [p[3] / p[4] for p in points]
+    low = min(min(intensities), min(peak / bw for bw, peak in ceilings.values())) / 4
+    high = max(max(intensities), max(peak / bw for bw, peak in ceilings.values())) * 4
+
+    plt.figure(figsize=(10, 6))
+
+    # Roofs: bandwidth slope up to the ridge, then the flat peak
+    linestyles = ['-', '--', ':', '-.']
+    for i, (label, (bandwidth, peak)) in enumerate(ceilings.items()):
+        ridge = peak / bandwidth
+        xs = [low, ridge, high]
+        ys = [bandwidth * low / 1e9, peak / 1e9, peak / 1e9]
+        plt.plot(xs, ys, color='black', linestyle=linestyles[i % len(linestyles)], linewidth=2.0,
+                 label=f"{label.replace('_', ' ')}: {bandwidth / 1e9:.1f} GB/s, {peak / 1e9:.1f} GFLOP/s")
+
+    # One series per engine, annotated with log2(n)
+    markers = ['o', 's', '^', 'D', 'v']
+    engines = sorted(set(p[0] for p in points), key=[p[0] for p in points].index)
+    for i, engine in enumerate(engines):
+        series = [p for p in points if p[0] == engine]
+        xs = [p[3] / p[4] for p in series]
+        ys = [p[3] / p[2] / 1e9 for p in series]
+        plt.plot(xs, ys, marker=markers[i % len(markers)], linestyle='', label=engine, alpha=0.8)
+        for p, x, y in zip(series, xs, ys):
+            plt.annotate(str(p[1].bit_length() - 1), (x, y), textcoords='offset points', xytext=(4, 4), fontsize=7)
+
+    plt.xscale('log', base=2)
+    plt.yscale('log', base=10)
+    plt.title('Roofline (labels: log2 of the transform size)')
+    plt.xlabel('Arithmetic intensity (flop/byte)')
+    plt.ylabel('Performance (GFLOP/s)')
+    plt.grid(True, which='both', alpha=0.3)
+    plt.legend()
+    base_name = os.path.splitext(os.path.basename(filename))[0]
+    output_image = f"{base_name}_plot.png"
+    plt.savefig(output_image)
+    print(f"Plot saved to {output_image}")
+    print(f"To view the plot, open {output_image}")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,134 @@
+/**
+ * @file Comparison.hpp
+ * @brief Header file for the cross-engine comparison table: timings, round-trip and pairwise errors.
+ */
+
+#ifndef COMPARISON_HPP
+#define COMPARISON_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Returns max |a[i] - b[i]| over two buffers of the same length.
+ * @throws std::invalid_argument If the lengths differ.
+ */
+inline double max_abs_difference(const std::vector<std::complex<double>>& a, const std::vector<std::complex<double>>& b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Cannot compare buffers of different lengths");
+    }
+    double largest = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) largest = std::max(largest, std::abs(a[i] - b[i]));
+    return largest;
+}
+
+/**
+ * @brief The results of one engine on the shared input.
+ */
+struct ComparedEngine {
+    std::string engine;                            ///< Engine name, e.g. "Iterative".
+    size_t n = 0;                                  ///< Transform length.
+    double forward = 0.0;                          ///< Median time of one compute().
+    double inverse = 0.0;                          ///< Median time of one reverseCompute().
+    double roundtrip = 0.0;                        ///< max |IFFT(reference spectrum) - input|.
+    std::vector<std::complex<double>> spectrum;    ///< Output of compute().
+};
+
+/**
+ * @class Comparison
+ * @brief Collects the engines run on one input and reports them side by side.
+ *
+ * Every row gives the median forward and inverse times, the round-trip error and
+ * the maximum difference between the engine's spectrum and every other engine's.
+ * Spectra of different lengths (an engine run on unpadded samples) are not compared.
+ */
+class Comparison {
+public:
+    /**
+     * @brief Adds the results of an engine.
+     * @param row The results; its spectrum must have the same length as the others.
+     */
+    void add(ComparedEngine row) { rows.push_back(std::move(row)); }
+
+    /**
+     * @brief Returns true if the spectra of engines i and j have the same length.
+     */
+    bool comparable(size_t i, size_t j) const { return rows[i].spectrum.size() == rows[j].spectrum.size(); }
+
+    /**
+     * @brief Returns the maximum difference between the spectra of engines i and j (NaN if not comparable).
+     */
+    double error(size_t i, size_t j) const {
+        if (!comparable(i, j)) return std::nan("");
+        return max_abs_difference(rows[i].spectrum, rows[j].spectrum);
+    }
+
+    /**
+     * @brief Prints one line per engine: timings, round-trip error and the pairwise spectrum errors.
+     * @param out The stream to print to.
+     */
+    void report(std::ostream& out = std::cout) const {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+
+        out << std::left << std::setw(12) << "engine" << std::right << std::setw(10) << "n"
+            << std::setw(12) << "FFT(us)" << std::setw(12) << "IFFT(us)" << std::setw(11) << "roundtrip";
+        for (const ComparedEngine& column : rows) out << std::setw(14) << ("vs " + column.engine.substr(0, 10));
+        out << std::endl;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const ComparedEngine& r = rows[i];
+            out << std::left << std::setw(12) << r.engine << std::right << std::setw(10) << r.n
+                << std::fixed << std::setprecision(1) << std::setw(12) << r.forward * 1e6 << std::setw(12) << r.inverse * 1e6
+                << std::scientific << std::setprecision(2) << std::setw(11) << r.roundtrip;
+            for (size_t j = 0; j < rows.size(); ++j) {
+                if (j == i || !comparable(i, j)) {
+                    out << std::setw(14) << "-";
+                } else {
+                    out << std::setw(14) << error(i, j);
+                }
+            }
+            out << std::endl;
+        }
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Writes the rows as a whitespace-separated table.
+     *
+     * Lines: "<engine> <n> <FFT seconds> <IFFT seconds> <roundtrip> <error vs engine 1> ... <error vs engine k>"
+     * (0 against itself, nan against a spectrum of another length), in the order of the rows.
+     *
+     * @param filename The path of the text file.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    void write(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file");
+        }
+        file << "# engine n fft_seconds ifft_seconds roundtrip";
+        for (const ComparedEngine& column : rows) file << " vs_" << column.engine;
+        file << "\n" << std::setprecision(8);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const ComparedEngine& r = rows[i];
+            file << r.engine << " " << r.n << " " << r.forward << " " << r.inverse << " " << r.roundtrip;
+            for (size_t j = 0; j < rows.size(); ++j) file << " " << (j == i ? 0.0 : error(i, j));
+            file << "\n";
+        }
+    }
+
+private:
+    std::vector<ComparedEngine> rows; ///< Engines, in the order they ran.
+};
+
+#endif // COMPARISON_HPP
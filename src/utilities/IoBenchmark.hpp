@@ -0,0 +1,322 @@
+/**
+ * @file IoBenchmark.hpp
+ * @brief Header file for the I/O microbenchmarks: text parse/format, binary and mmap loads of samples.
+ */
+
+#ifndef IO_BENCHMARK_HPP
+#define IO_BENCHMARK_HPP
+
+#include "Timer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <complex>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief One measured I/O operation.
+ */
+struct IoMeasurement {
+    std::string operation; ///< e.g. "read()", "parse", "binary".
+    std::string format;    ///< "real" or "complex".
+    size_t samples = 0;    ///< Values loaded or stored.
+    size_t bytes = 0;      ///< Size of the file.
+    int threads = 1;       ///< OpenMP threads used.
+    double seconds = 0.0;  ///< Median time of one operation.
+
+    double megabytes_per_second() const { return seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e6 : 0.0; }
+    double samples_per_second() const { return seconds > 0.0 ? static_cast<double>(samples) / seconds : 0.0; }
+};
+
+/**
+ * @brief Returns the size of a file in bytes.
+ * @throws std::runtime_error If the file does not exist.
+ */
+inline size_t file_size(const std::string& path) {
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("Could not open file");
+    }
+    return static_cast<size_t>(info.st_size);
+}
+
+/**
+ * @brief Evicts a file from the page cache, so that the next load reads the device (best effort).
+ */
+inline void drop_page_cache(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+/**
+ * @brief Parses a text file of samples (one real or "(re,im)" value per line) with several threads.
+ *
+ * The file is read in one block, cut into one range per thread at line boundaries,
+ * and every thread parses its range with strtod into a private vector; the vectors
+ * are then concatenated in order. This is the parse throughput without the
+ * iostream machinery of Fourier::read().
+ *
+ * @param path The text file.
+ * @param threads The number of OpenMP threads.
+ * @return std::vector<std::complex<double>> The samples.
+ * @throws std::runtime_error If the file cannot be opened.
+ */
+inline std::vector<std::complex<double>> parse_text_parallel(const std::string& path, int threads) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    std::string text(file_size(path), '\0');
+    file.read(&text[0], static_cast<std::streamsize>(text.size()));
+
+    const int parts = std::max(threads, 1);
+    std::vector<size_t> cut(parts + 1, text.size());
+    cut[0] = 0;
+    for (int p = 1; p < parts; ++p) {
+        size_t at = std::max(text.size() * p / parts, cut[p - 1]);
+        while (at < text.size() && text[at] != '\n') ++at;
+        cut[p] = std::min(at + 1, text.size());
+    }
+
+    std::vector<std::vector<std::complex<double>>> pieces(parts);
+    #pragma omp parallel for num_threads(parts) schedule(static, 1)
+    for (int p = 0; p < parts; ++p) {
+        const char* cursor = text.c_str() + cut[p];
+        const char* end = text.c_str() + cut[p + 1];
+        std::vector<std::complex<double>>& out = pieces[p];
+        out.reserve((cut[p + 1] - cut[p]) / 10);
+        while (cursor < end) {
+            while (cursor < end && std::isspace(static_cast<unsigned char>(*cursor))) ++cursor;
+            if (cursor >= end) break;
+            char* next = nullptr;
+            if (*cursor == '(') {
+                const double re = std::strtod(cursor + 1, &next);
+                const double im = std::strtod(next + 1, &next); // skips ','
+                out.emplace_back(re, im);
+                cursor = next + 1;                              // skips ')'
+            } else {
+                const double re = std::strtod(cursor, &next);
+                if (next == cursor) break; // not a number
+                out.emplace_back(re, 0.0);
+                cursor = next;
+            }
+        }
+    }
+
+    std::vector<std::complex<double>> samples;
+    size_t total = 0;
+    for (const auto& piece : pieces) total += piece.size();
+    samples.reserve(total);
+    for (const auto& piece : pieces) samples.insert(samples.end(), piece.begin(), piece.end());
+    return samples;
+}
+
+/**
+ * @brief Writes samples as text (the format of Fourier::write()/writeReal()) with several threads.
+ *
+ * Every thread formats its share of the values with snprintf("%.6f") into a private
+ * buffer; the buffers are then written to the file in order with one call each.
+ *
+ * @param path The text file to create.
+ * @param data The samples.
+ * @param n The number of samples.
+ * @param real If true, writes only the real parts (writeReal()), else "(re,im)".
+ * @param threads The number of OpenMP threads.
+ * @throws std::runtime_error If the file cannot be opened.
+ */
+inline void format_text_parallel(const std::string& path, const std::complex<double>* data, size_t n, bool real, int threads) {
+    const int parts = std::max(threads, 1);
+    std::vector<std::string> pieces(parts);
+
+    #pragma omp parallel for num_threads(parts) schedule(static, 1)
+    for (int p = 0; p < parts; ++p) {
+        const size_t first = n * p / parts, last = n * (p + 1) / parts;
+        std::string& out = pieces[p];
+        out.reserve((last - first) * (real ? 12 : 26));
+        char line[768]; // "%.6f" of the largest double takes 316 characters
+        for (size_t i = first; i < last; ++i) {
+            const int length = real ? std::snprintf(line, sizeof(line), "%.6f\n", data[i].real())
+                                    : std::snprintf(line, sizeof(line), "(%.6f,%.6f)\n", data[i].real(), data[i].imag());
+            out.append(line, static_cast<size_t>(length));
+        }
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Could not open file");
+    }
+    for (const std::string& piece : pieces) std::fwrite(piece.data(), 1, piece.size(), file);
+    std::fclose(file);
+}
+
+/**
+ * @brief Writes samples as raw doubles: real parts only, or interleaved real and imaginary parts.
+ * @throws std::runtime_error If the file cannot be opened.
+ */
+inline void write_binary(const std::string& path, const std::complex<double>* data, size_t n, bool real) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file");
+    }
+    if (real) {
+        std::vector<double> values(n);
+        for (size_t i = 0; i < n; ++i) values[i] = data[i].real();
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(n * sizeof(double)));
+    } else {
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(n * sizeof(std::complex<double>)));
+    }
+}
+
+/**
+ * @brief Loads a raw binary file of samples with one pread() per thread into disjoint slices.
+ *
+ * @param path The binary file (see write_binary()).
+ * @param real If true, the file holds doubles that become real samples.
+ * @param threads The number of OpenMP threads.
+ * @return std::vector<std::complex<double>> The samples.
+ * @throws std::runtime_error If the file cannot be opened or read.
+ */
+inline std::vector<std::complex<double>> load_binary_parallel(const std::string& path, bool real, int threads) {
+    const size_t value_bytes = real ? sizeof(double) : sizeof(std::complex<double>);
+    const size_t n = file_size(path) / value_bytes;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file");
+    }
+
+    std::vector<std::complex<double>> samples(n);
+    const int parts = std::max(threads, 1);
+    bool failed = false;
+    #pragma omp parallel for num_threads(parts) schedule(static, 1) reduction(|| : failed)
+    for (int p = 0; p < parts; ++p) {
+        const size_t first = n * p / parts, last = n * (p + 1) / parts;
+        std::vector<double> staging(real ? last - first : 0);
+        char* destination = real ? reinterpret_cast<char*>(staging.data()) : reinterpret_cast<char*>(samples.data() + first);
+        size_t done = 0, wanted = (last - first) * value_bytes;
+        while (done < wanted) {
+            const ssize_t got = ::pread(fd, destination + done, wanted - done, static_cast<off_t>(first * value_bytes + done));
+            if (got <= 0) {
+                failed = true;
+                break;
+            }
+            done += static_cast<size_t>(got);
+        }
+        for (size_t i = 0; i < staging.size(); ++i) samples[first + i] = std::complex<double>(staging[i], 0.0);
+    }
+    ::close(fd);
+    if (failed) {
+        throw std::runtime_error("Could not read file");
+    }
+    return samples;
+}
+
+/**
+ * @brief Loads a raw binary file of samples through a read-only mapping, one slice per thread.
+ *
+ * The threads copy (and convert) their slices out of the mapping, so the page faults
+ * are taken in parallel.
+ *
+ * @param path The binary file (see write_binary()).
+ * @param real If true, the file holds doubles that become real samples.
+ * @param threads The number of OpenMP threads.
+ * @return std::vector<std::complex<double>> The samples.
+ * @throws std::runtime_error If the file cannot be opened or mapped.
+ */
+inline std::vector<std::complex<double>> load_mapped_parallel(const std::string& path, bool real, int threads) {
+    const size_t bytes = file_size(path);
+    const size_t n = bytes / (real ? sizeof(double) : sizeof(std::complex<double>));
+    std::vector<std::complex<double>> samples(n);
+    if (n == 0) return samples;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file");
+    }
+    void* base = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Could not map file");
+    }
+
+    const int parts = std::max(threads, 1);
+    #pragma omp parallel for num_threads(parts) schedule(static)
+    for (long long i = 0; i < static_cast<long long>(n); ++i) {
+        samples[i] = real ? std::complex<double>(static_cast<const double*>(base)[i], 0.0)
+                          : static_cast<const std::complex<double>*>(base)[i];
+    }
+    ::munmap(base, bytes);
+    return samples;
+}
+
+/**
+ * @class IoReport
+ * @brief Table of I/O measurements, printed and saved so that runs can be compared over time.
+ */
+class IoReport {
+public:
+    /**
+     * @brief Adds a measurement.
+     */
+    void add(const IoMeasurement& m) { rows.push_back(m); }
+
+    /**
+     * @brief Prints one line per measurement: MB/s and millions of samples per second.
+     * @param out The stream to print to.
+     */
+    void report(std::ostream& out = std::cout) const {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(2);
+        out << std::left << std::setw(12) << "operation" << std::setw(9) << "format" << std::right
+            << std::setw(10) << "samples" << std::setw(12) << "bytes" << std::setw(8) << "threads"
+            << std::setw(12) << "time(ms)" << std::setw(10) << "MB/s" << std::setw(12) << "Msamples/s" << std::endl;
+        for (const IoMeasurement& m : rows) {
+            out << std::left << std::setw(12) << m.operation << std::setw(9) << m.format << std::right
+                << std::setw(10) << m.samples << std::setw(12) << m.bytes << std::setw(8) << m.threads
+                << std::setw(12) << m.seconds * 1e3 << std::setw(10) << m.megabytes_per_second()
+                << std::setw(12) << m.samples_per_second() / 1e6 << std::endl;
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Writes the measurements as a whitespace-separated table.
+     *
+     * Lines: "<operation> <format> <samples> <bytes> <threads> <seconds> <MB/s> <samples/s>".
+     *
+     * @param filename The path of the text file.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    void write(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file");
+        }
+        file << "# operation format samples bytes threads seconds MB/s samples/s\n" << std::setprecision(8);
+        for (const IoMeasurement& m : rows) {
+            file << m.operation << " " << m.format << " " << m.samples << " " << m.bytes << " " << m.threads << " "
+                 << m.seconds << " " << m.megabytes_per_second() << " " << m.samples_per_second() << "\n";
+        }
+    }
+
+private:
+    std::vector<IoMeasurement> rows; ///< Measurements, in insertion order.
+};
+
+#endif // IO_BENCHMARK_HPP
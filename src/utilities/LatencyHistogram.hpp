@@ -0,0 +1,183 @@
+/**
+ * @file LatencyHistogram.hpp
+ * @brief Header file for the LatencyHistogram and LatencyRecorder utility classes.
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear (HDR-style) histogram of latencies in nanoseconds.
+ *
+ * Values below 2^SUB_BITS are counted exactly; above that, every power of 2 is split
+ * into 2^SUB_BITS equal buckets, so any reported percentile is within 1/128 (< 0.8%)
+ * of the true value. record() is a handful of integer operations and one increment,
+ * with a fixed table allocated up front, so it can run on every transform. The
+ * maximum is kept exactly.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * @brief Creates an empty histogram covering 0 .. 2^MAX_BITS ns (about 18 minutes).
+     */
+    LatencyHistogram() : counts((MAX_BITS - SUB_BITS + 1) << SUB_BITS, 0), total(0), largest(0) {}
+
+    /**
+     * @brief Counts one latency (larger values than the range land in the last bucket).
+     * @param ns The latency in nanoseconds.
+     */
+    void record(long long ns) {
+        const uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        counts[std::min(index(value), counts.size() - 1)]++;
+        total++;
+        largest = std::max(largest, value);
+    }
+
+    /**
+     * @brief Returns the number of recorded latencies.
+     */
+    uint64_t count() const { return total; }
+
+    /**
+     * @brief Returns the largest recorded latency in nanoseconds.
+     */
+    uint64_t max() const { return largest; }
+
+    /**
+     * @brief Returns the latency below which the fraction q of the recorded values lie.
+     *
+     * @param q The quantile, between 0 and 1 (e.g. 0.99 for p99).
+     * @return uint64_t The upper edge of the bucket holding that rank (capped at max()), 0 if empty.
+     */
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        const double clamped = std::min(std::max(q, 0.0), 1.0);
+        uint64_t rank = static_cast<uint64_t>(clamped * static_cast<double>(total) + 0.5);
+        rank = std::max<uint64_t>(rank, 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(upper_edge(i), largest);
+        }
+        return largest;
+    }
+
+    /**
+     * @brief Forgets every recorded value.
+     */
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        largest = 0;
+    }
+
+private:
+    static constexpr unsigned SUB_BITS = 7;  ///< log2 of the buckets per power of 2.
+    static constexpr unsigned MAX_BITS = 40; ///< log2 of the covered range in ns.
+
+    /**
+     * @brief Returns the bucket of a value: exact below 2^SUB_BITS, log-linear above.
+     */
+    static size_t index(uint64_t value) {
+        if (value < (uint64_t(1) << SUB_BITS)) return static_cast<size_t>(value);
+        unsigned top = 63 - static_cast<unsigned>(__builtin_clzll(value)); // floor(log2(value))
+        unsigned shift = top - SUB_BITS;
+        return (static_cast<size_t>(shift + 1) << SUB_BITS) + static_cast<size_t>((value >> shift) - (uint64_t(1) << SUB_BITS));
+    }
+
+    /**
+     * @brief Returns the largest value that falls into bucket i.
+     */
+    static uint64_t upper_edge(size_t i) {
+        if (i < (size_t(1) << SUB_BITS)) return i;
+        unsigned shift = static_cast<unsigned>(i >> SUB_BITS) - 1;
+        uint64_t mantissa = (uint64_t(1) << SUB_BITS) + (i & ((size_t(1) << SUB_BITS) - 1));
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts; ///< Values per bucket.
+    uint64_t total;               ///< Number of recorded values.
+    uint64_t largest;             ///< Largest recorded value.
+};
+
+/**
+ * @class LatencyRecorder
+ * @brief One LatencyHistogram per transform size, with a percentile report.
+ *
+ * The histogram of a size is created by prepare() or by its first record(); later
+ * records of the same size only look it up, so repeated transforms of one plan do
+ * not allocate.
+ */
+class LatencyRecorder {
+public:
+    /**
+     * @brief Creates the histogram of a size up front (e.g. before entering a real-time loop).
+     * @param n The transform size.
+     */
+    void prepare(size_t n) {
+        histograms[n];
+    }
+
+    /**
+     * @brief Counts one latency of a transform of the given size.
+     * @param n The transform size.
+     * @param ns The latency in nanoseconds.
+     */
+    void record(size_t n, long long ns) {
+        histograms[n].record(ns);
+    }
+
+    /**
+     * @brief Returns true if nothing was recorded.
+     */
+    bool empty() const { return histograms.empty(); }
+
+    /**
+     * @brief Returns the histograms by transform size.
+     */
+    const std::map<size_t, LatencyHistogram>& bySize() const { return histograms; }
+
+    /**
+     * @brief Forgets every recorded value.
+     */
+    void reset() { histograms.clear(); }
+
+    /**
+     * @brief Prints count, p50, p90, p99, p99.9 and max (in microseconds) for every size.
+     * @param label The line prefix, e.g. "Iterative FFT".
+     * @param out The stream to print to.
+     */
+    void report(const std::string& label, std::ostream& out = std::cout) const {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(1);
+        for (const auto& entry : histograms) {
+            const LatencyHistogram& h = entry.second;
+            if (h.count() == 0) continue;
+            out << label << " latency n=" << entry.first << " (" << h.count() << " runs):"
+                << " p50 " << h.percentile(0.50) / 1e3
+                << " p90 " << h.percentile(0.90) / 1e3
+                << " p99 " << h.percentile(0.99) / 1e3
+                << " p99.9 " << h.percentile(0.999) / 1e3
+                << " max " << h.max() / 1e3 << " us" << std::endl;
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    std::map<size_t, LatencyHistogram> histograms; ///< Histogram per transform size.
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,90 @@
+/**
+ * @file MappedFile.hpp
+ * @brief Header file for the MappedFile utility class.
+ */
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @class MappedFile
+ * @brief A binary file of n elements of type T mapped read-write into memory.
+ *
+ * Stores written through data() land in the page cache of the file itself, so the
+ * file holds the raw elements (e.g. interleaved real/imaginary doubles for
+ * std::complex<double>) without any serialization pass or second buffer.
+ * The mapping is flushed and released by the destructor.
+ *
+ * @tparam T The element type (trivially copyable).
+ */
+template <typename T>
+class MappedFile {
+public:
+    /**
+     * @brief Creates (or truncates) the file to n elements and maps it.
+     *
+     * @param path The file path.
+     * @param n The number of elements.
+     * @throws std::runtime_error If the file cannot be created, resized or mapped.
+     */
+    MappedFile(const std::string& path, size_t n) : count(n), fd(-1), base(nullptr) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file");
+        }
+
+        const size_t bytes = n * sizeof(T);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not resize file");
+        }
+
+        if (bytes > 0) {
+            void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (address == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file");
+            }
+            base = static_cast<T*>(address);
+        }
+    }
+
+    /**
+     * @brief Flushes the mapping to the file and releases it.
+     */
+    ~MappedFile() {
+        if (base != nullptr) {
+            ::msync(base, count * sizeof(T), MS_SYNC);
+            ::munmap(base, count * sizeof(T));
+        }
+        if (fd >= 0) ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Returns the mapped elements.
+     */
+    T* data() const { return base; }
+
+    /**
+     * @brief Returns the number of mapped elements.
+     */
+    size_t size() const { return count; }
+
+private:
+    size_t count; ///< Number of elements.
+    int fd;       ///< File descriptor of the mapped file.
+    T* base;      ///< Start of the mapping.
+};
+
+#endif // MAPPED_FILE_HPP
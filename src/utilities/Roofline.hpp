@@ -0,0 +1,292 @@
+/**
+ * @file Roofline.hpp
+ * @brief Header file for the roofline model: machine ceilings, FFT work/traffic estimates and the report.
+ */
+
+#ifndef ROOFLINE_HPP
+#define ROOFLINE_HPP
+
+#include "Timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Sustained limits of the machine (or of a group of processes).
+ */
+struct MachineLimits {
+    std::string label;      ///< Name of the ceiling, e.g. "rank 0" or "4 ranks".
+    double bandwidth = 0.0; ///< Memory bandwidth in bytes per second.
+    double peak = 0.0;      ///< Double-precision floating-point operations per second.
+
+    /**
+     * @brief Returns the arithmetic intensity (flop/byte) where the two ceilings meet.
+     */
+    double ridge() const { return bandwidth > 0.0 ? peak / bandwidth : 0.0; }
+
+    /**
+     * @brief Returns the attainable flop/s at the given arithmetic intensity: min(peak, bandwidth * intensity).
+     */
+    double attainable(double intensity) const { return std::min(peak, bandwidth * intensity); }
+};
+
+/**
+ * @brief Returns the size of the last-level data cache in bytes (8 MiB if the system does not report it).
+ */
+inline size_t last_level_cache() {
+    long size = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size <= 0) size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return size > 0 ? static_cast<size_t>(size) : size_t(8) << 20;
+}
+
+/**
+ * @brief Measures the sustained memory bandwidth with the STREAM triad a[i] = b[i] + s * c[i].
+ *
+ * The three arrays are initialized by the OpenMP threads that later sweep them (first
+ * touch), every trial is timed separately and the best one is kept. Each element moves
+ * 24 bytes (two loads, one store), as counted by STREAM; write-allocate traffic is not.
+ *
+ * @param elements Doubles per array; should exceed 4x the last-level cache for a DRAM figure.
+ * @param trials Number of timed sweeps.
+ * @return double Bytes per second of the best trial.
+ */
+inline double measure_bandwidth(size_t elements, int trials = 5) {
+    if (elements == 0 || trials <= 0) {
+        throw std::invalid_argument("Bandwidth probe needs elements and trials");
+    }
+    // Uninitialized storage, so that the pages are placed by the threads' first touch
+    std::unique_ptr<double[]> a(new double[elements]), b(new double[elements]), c(new double[elements]);
+    double* pa = a.get();
+    double* pb = b.get();
+    double* pc = c.get();
+
+    const long long count = static_cast<long long>(elements);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; ++i) {
+        pa[i] = 0.0;
+        pb[i] = 1.0;
+        pc[i] = 2.0;
+    }
+
+    const double scalar = 3.0;
+    long long best = 0;
+    for (int t = 0; t < trials; ++t) {
+        Timer timer;
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i) pa[i] = pb[i] + scalar * pc[i];
+        const long long ns = std::max(timer.stop_and_return_ns(), 1LL);
+        if (best == 0 || ns < best) best = ns;
+    }
+    volatile double sink = pa[count / 2];
+    (void)sink;
+    return 24.0 * static_cast<double>(elements) / (static_cast<double>(best) * 1e-9);
+}
+
+/**
+ * @brief Measures the peak double-precision flop/s reachable by compiled code.
+ *
+ * Every OpenMP thread updates 32 independent accumulators with acc = acc * m + a,
+ * which the compiler vectorizes into as many independent multiply and add chains as
+ * the target ISA allows. The figure is therefore the peak of this build (e.g. SSE2
+ * without -march=native), which is also the ceiling of the engines compiled with it.
+ *
+ * @param iterations Updates of every accumulator per thread.
+ * @param trials Number of timed runs (the best one is kept).
+ * @return double Floating-point operations per second of the best trial.
+ */
+inline double measure_peak_flops(size_t iterations = size_t(1) << 22, int trials = 3) {
+    constexpr size_t LANES = 32;
+    double best = 0.0;
+    for (int t = 0; t < trials; ++t) {
+        double flops = 0.0, checksum = 0.0;
+        Timer timer;
+        #pragma omp parallel reduction(+ : flops, checksum)
+        {
+            double acc[LANES];
+            for (size_t j = 0; j < LANES; ++j) acc[j] = 1.0 + 1e-3 * static_cast<double>(j);
+            const double m = 0.999999, a = 1e-6;
+            for (size_t it = 0; it < iterations; ++it) {
+                for (size_t j = 0; j < LANES; ++j) acc[j] = acc[j] * m + a;
+            }
+            for (size_t j = 0; j < LANES; ++j) checksum += acc[j];
+            flops += 2.0 * LANES * static_cast<double>(iterations);
+        }
+        const double seconds = static_cast<double>(std::max(timer.stop_and_return_ns(), 1LL)) * 1e-9;
+        volatile double sink = checksum;
+        (void)sink;
+        best = std::max(best, flops / seconds);
+    }
+    return best;
+}
+
+/**
+ * @brief Returns the conventional flop count of a complex FFT of length n: 5 n log2(n).
+ */
+inline double fft_flops(size_t n) {
+    return n < 2 ? 0.0 : 5.0 * static_cast<double>(n) * std::log2(static_cast<double>(n));
+}
+
+/**
+ * @brief Estimates the memory traffic of a complex FFT of length n, in bytes.
+ *
+ * Every pass reads and writes the whole array. A cache holding C values (input and
+ * output) lets one pass cover log2(C) butterfly stages, so the transform needs
+ * ceil(log2(n) / log2(C)) passes (the Hong-Kung bound of FFT I/O), at least one.
+ *
+ * @param n The transform length.
+ * @param cache_bytes The capacity of the cache between the cores and memory.
+ * @param value_bytes Bytes per complex value (16 for std::complex<double>).
+ * @return double The estimated bytes moved to and from memory.
+ */
+inline double fft_bytes(size_t n, size_t cache_bytes, size_t value_bytes = sizeof(std::complex<double>)) {
+    if (n < 2) return 2.0 * static_cast<double>(value_bytes * n);
+    const double stages = std::log2(static_cast<double>(n));
+    const double resident = static_cast<double>(cache_bytes) / (2.0 * static_cast<double>(value_bytes));
+    const double per_pass = resident >= 2.0 ? std::log2(resident) : 1.0;
+    const double passes = std::max(1.0, std::ceil(stages / per_pass));
+    return passes * 2.0 * static_cast<double>(value_bytes) * static_cast<double>(n);
+}
+
+/**
+ * @brief One measured transform placed on the roofline.
+ */
+struct RooflinePoint {
+    std::string engine;   ///< Engine name, e.g. "Iterative".
+    size_t n = 0;         ///< Transform length.
+    double seconds = 0.0; ///< Measured (median) time of one transform.
+    double flops = 0.0;   ///< Counted floating-point operations.
+    double bytes = 0.0;   ///< Estimated memory traffic.
+    MachineLimits limits; ///< Ceiling of the processes that ran it.
+
+    double intensity() const { return bytes > 0.0 ? flops / bytes : 0.0; }
+    double performance() const { return seconds > 0.0 ? flops / seconds : 0.0; }
+    double bandwidth() const { return seconds > 0.0 ? bytes / seconds : 0.0; }
+};
+
+/**
+ * @class Roofline
+ * @brief Collects measured transforms and reports where they sit below the machine ceilings.
+ *
+ * For every point the report gives the achieved GFLOP/s and GB/s, the arithmetic
+ * intensity, whether the roofline at that intensity is the memory or the compute
+ * ceiling, and the fraction of the attainable performance reached.
+ */
+class Roofline {
+public:
+    /**
+     * @brief Adds a measured transform.
+     * @param engine The engine name.
+     * @param n The transform length.
+     * @param seconds The time of one transform.
+     * @param limits The ceiling of the processes that computed it.
+     * @param cache_bytes The cache capacity used by the traffic estimate (see fft_bytes()).
+     */
+    void add(const std::string& engine, size_t n, double seconds, const MachineLimits& limits, size_t cache_bytes) {
+        RooflinePoint p;
+        p.engine = engine;
+        p.n = n;
+        p.seconds = seconds;
+        p.flops = fft_flops(n);
+        p.bytes = fft_bytes(n, cache_bytes);
+        p.limits = limits;
+        points.push_back(p);
+    }
+
+    /**
+     * @brief Returns the points added so far.
+     */
+    const std::vector<RooflinePoint>& entries() const { return points; }
+
+    /**
+     * @brief Prints the ceilings and one line per point.
+     * @param out The stream to print to.
+     */
+    void report(std::ostream& out = std::cout) const {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(2);
+
+        for (const MachineLimits& m : ceilings()) {
+            out << "Roofline ceiling " << m.label << ": " << m.bandwidth / 1e9 << " GB/s, "
+                << m.peak / 1e9 << " GFLOP/s, ridge " << m.ridge() << " flop/byte" << std::endl;
+        }
+        out << std::left << std::setw(12) << "engine" << std::right << std::setw(10) << "n"
+            << std::setw(12) << "time(us)" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+            << std::setw(10) << "flop/B" << std::setw(9) << "bound" << std::setw(10) << "roof" << std::setw(9) << "% roof" << std::endl;
+        for (const RooflinePoint& p : points) {
+            const double roof = p.limits.attainable(p.intensity());
+            out << std::left << std::setw(12) << p.engine << std::right << std::setw(10) << p.n
+                << std::setw(12) << p.seconds * 1e6 << std::setw(10) << p.performance() / 1e9
+                << std::setw(10) << p.bandwidth() / 1e9 << std::setw(10) << p.intensity()
+                << std::setw(9) << (p.intensity() < p.limits.ridge() ? "memory" : "compute")
+                << std::setw(10) << roof / 1e9 << std::setw(9) << (roof > 0.0 ? 100.0 * p.performance() / roof : 0.0)
+                << std::endl;
+        }
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Writes the ceilings and the points as a whitespace-separated table (read by plot_roofline.py).
+     *
+     * Ceiling lines: "# ceiling <label> <bytes/s> <flop/s>" (spaces in labels become '_').
+     * Point lines: "<engine> <n> <seconds> <flops> <bytes> <ceiling label>".
+     *
+     * @param filename The path of the text file.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    void write(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file");
+        }
+        file << std::setprecision(10);
+        for (const MachineLimits& m : ceilings()) {
+            file << "# ceiling " << token(m.label) << " " << m.bandwidth << " " << m.peak << "\n";
+        }
+        file << "# engine n seconds flops bytes ceiling\n";
+        for (const RooflinePoint& p : points) {
+            file << p.engine << " " << p.n << " " << p.seconds << " " << p.flops << " " << p.bytes
+                 << " " << token(p.limits.label) << "\n";
+        }
+    }
+
+private:
+    std::vector<RooflinePoint> points; ///< Measured transforms, in insertion order.
+
+    /**
+     * @brief Returns the distinct ceilings of the points, in order of first use.
+     */
+    std::vector<MachineLimits> ceilings() const {
+        std::vector<MachineLimits> found;
+        for (const RooflinePoint& p : points) {
+            bool known = false;
+            for (const MachineLimits& m : found) known = known || m.label == p.limits.label;
+            if (!known) found.push_back(p.limits);
+        }
+        return found;
+    }
+
+    /**
+     * @brief Replaces spaces with '_' so that a label is one column of the table.
+     */
+    static std::string token(std::string label) {
+        std::replace(label.begin(), label.end(), ' ', '_');
+        return label;
+    }
+};
+
+#endif // ROOFLINE_HPP
@@ -1,15 +1,17 @@
 /**
  * @file Timer.hpp
- * @brief Header file for the Timer utility class.
+ * @brief Header file for the Timer utility class and the median_seconds() benchmark helper.
  */
 
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <string>
+#include <vector>
 
 /**
  * @class Timer
@@ -41,6 +43,16 @@ public:
         return duration.count();
     }
 
+    /**
+     * @brief Stops the timer and returns the elapsed time in nanoseconds.
+     * 
+     * @return long long The elapsed time in nanoseconds.
+     */
+    long long stop_and_return_ns() {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+    }
+
     /**
      * @brief Stops the timer and prints the elapsed time to standard output.
      * 
@@ -59,4 +71,31 @@ private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
 };
 
+/**
+ * @brief Runs body `repeat` times and returns the median time of one run in seconds.
+ * @param repeat The number of timed runs.
+ * @param body The operation to time.
+ * @param before Called (untimed) before every run, e.g. to evict the file from the page cache.
+ */
+template <typename Body, typename Before>
+double median_seconds(int repeat, Body&& body, Before&& before) {
+    std::vector<long long> times;
+    for (int r = 0; r < std::max(repeat, 1); ++r) {
+        before();
+        Timer t;
+        body();
+        times.push_back(t.stop_and_return_ns());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return static_cast<double>(times[times.size() / 2]) * 1e-9;
+}
+
+/**
+ * @brief Runs body `repeat` times and returns the median time of one run in seconds.
+ */
+template <typename Body>
+double median_seconds(int repeat, Body&& body) {
+    return median_seconds(repeat, body, [] {});
+}
+
 #endif // TIMER_HPP
\ No newline at end of file